@@ -6,6 +6,9 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "mat4_math.h"
 
 // Default camera values
 const float YAW         = -90.0f;
@@ -15,6 +18,13 @@ const float SENSITIVITY =  0.1f;
 const float ZOOM        =  45.0f;
 
 
+// How yaw and pitch become the camera's orientation: euler rebuilds the basis from the two angles, quaternion composes the
+// accumulated deltas onto a stored rotation and reads the basis straight off it
+enum class camera_orientation {
+    euler,
+    quaternion
+};
+
 // Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
 enum camera_movement {
     FORWARD,
@@ -29,9 +39,6 @@ class Camera
 public:
     // camera Attributes
     glm::vec3 position;
-    glm::vec3 front;
-    glm::vec3 up;
-    glm::vec3 right;
     glm::vec3 world_up;
     // euler Angles
     float yaw;
@@ -42,34 +49,157 @@ public:
     float zoom;
 
     // constructor with vectors
-    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : front(glm::vec3(0.0f, 0.0f, -1.0f)), movement_speed(SPEED), mouse_sensitivity(SENSITIVITY), zoom(ZOOM)
+    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : movement_speed(SPEED), mouse_sensitivity(SENSITIVITY), zoom(ZOOM)
     {
         this->position = position;
         world_up = up;
         this->yaw = yaw;
         this->pitch = pitch;
-        update_camera_vectors();
+        invalidate_view();
     }
     // constructor with scalar values
-    Camera(float pos_x, float pos_y, float pos_z, float up_x, float up_y, float up_z, float yaw, float pitch) : front(glm::vec3(0.0f, 0.0f, -1.0f)), movement_speed(SPEED), mouse_sensitivity(SENSITIVITY), zoom(ZOOM)
+    Camera(float pos_x, float pos_y, float pos_z, float up_x, float up_y, float up_z, float yaw, float pitch) : movement_speed(SPEED), mouse_sensitivity(SENSITIVITY), zoom(ZOOM)
     {
         position = glm::vec3(pos_x, pos_y, pos_z);
         world_up = glm::vec3(up_x, up_y, up_z);
         this->yaw = yaw;
         this->pitch = pitch;
+        invalidate_view();
+    }
+
+    // returns the view matrix for the current position and basis vectors; it's only rebuilt after the camera moved or turned
+    const glm::mat4& get_view_matrix()
+    {
+        if (view_dirty)
+        {
+            update_camera_vectors();
+
+            // the basis is already orthonormal, so the view is the rigid inverse of the camera's world transform rather than
+            // a full lookAt
+            view_matrix = mat4_view_from_basis(right, up, front, get_render_position());
+
+            view_dirty = false;
+        }
+
+        return view_matrix;
+    }
+
+    // projection * view, rebuilt only when either of them changed
+    const glm::mat4& get_view_projection_matrix()
+    {
+        if (view_projection_dirty)
+        {
+            view_projection_matrix = mat4_multiply(projection_matrix, get_view_matrix());
+            view_projection_dirty = false;
+        }
+
+        return view_projection_matrix;
+    }
+
+    const glm::mat4& get_projection_matrix() const
+    {
+        return projection_matrix;
+    }
+
+    // setting the same projection again is free and keeps the cached view-projection
+    void set_projection_matrix(const glm::mat4& matrix)
+    {
+        if (matrix == projection_matrix) return;
+
+        projection_matrix = matrix;
+        view_projection_dirty = true;
+        revision++;
+    }
+
+    // changes whenever the view or projection did, so anything derived from them (uniform buffers, frustum planes) can be
+    // rebuilt only when this differs from the revision it was built at
+    unsigned int get_revision() const
+    {
+        return revision;
+    }
+
+    // Call at the start of every fixed simulation step, before the step moves the camera; the position it had here is where
+    // rendering interpolates from
+    void begin_simulation_step()
+    {
+        if (previous_position == position) return;
+
+        previous_position = position;
+        mark_view_dirty();
+    }
+
+    // Once per rendered frame: how far between the previous and the current step's position the view is placed, in [0, 1].
+    // Orientation isn't interpolated, it follows mouse input every frame. Cameras that never get this render at position.
+    void set_render_interpolation(float alpha)
+    {
+        if (alpha == interpolation_alpha) return;
+
+        interpolation_alpha = alpha;
+        if (previous_position != position)
+            mark_view_dirty();
+    }
+
+    // where the view is placed: position, unless an interpolation between simulation steps is in progress
+    glm::vec3 get_render_position() const
+    {
+        if (previous_position == position)
+            return position;
+
+        // exact at both ends, alpha 0 and 1 give the stored positions bit for bit
+        return previous_position * (1.0f - interpolation_alpha) + position * interpolation_alpha;
+    }
+
+    // position, yaw and pitch may also be written directly, as long as this is called afterwards; a moved position is
+    // jumped to rather than interpolated towards
+    void invalidate_view()
+    {
+        previous_position = position;
+        if (orientation_mode == camera_orientation::quaternion)
+            orientation = orientation_from_euler();
+        pending_yaw = 0.f;
+        pending_pitch = 0.f;
+        mark_basis_dirty();
+    }
+
+    camera_orientation get_orientation_mode() const
+    {
+        return orientation_mode;
+    }
+
+    void set_orientation_mode(camera_orientation mode)
+    {
+        if (mode == orientation_mode) return;
+
+        orientation_mode = mode;
+        invalidate_view();
+    }
+
+    // the basis vectors are rebuilt here, on first read after the camera turned, rather than on every mouse event
+    const glm::vec3& get_front()
+    {
+        update_camera_vectors();
+        return front;
+    }
+
+    const glm::vec3& get_right()
+    {
         update_camera_vectors();
+        return right;
     }
 
-    // returns the view matrix calculated using Euler Angles and the LookAt Matrix
-    glm::mat4 get_view_matrix()
+    const glm::vec3& get_up()
     {
-        return glm::lookAt(position, position + front, up);
+        update_camera_vectors();
+        return up;
     }
 
     // processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
     void process_keyboard(camera_movement direction, float delta_time)
     {
         float velocity = movement_speed * delta_time;
+        if (velocity == 0.f)
+            return;
+        update_camera_vectors();
         if (direction == FORWARD)
             position += glm::vec3(front.x, 0.f, front.z) * velocity;
         if (direction == BACKWARD)
@@ -78,6 +208,7 @@ public:
             position -= right * velocity;
         if (direction == RIGHT)
             position += right * velocity;
+        mark_view_dirty();
     }
 
     // processes input received from a mouse input system. Expects the offset value in both the x and y direction.
@@ -86,6 +217,7 @@ public:
         x_offset *= mouse_sensitivity;
         y_offset *= mouse_sensitivity;
 
+        float previous_pitch = pitch;
         yaw   += x_offset;
         pitch += y_offset;
 
@@ -98,8 +230,10 @@ public:
                 pitch = -89.0f;
         }
 
-        // update Front, Right and Up Vectors using the updated Euler angles
-        update_camera_vectors();
+        // only the deltas are kept here; the basis follows on its next read, however many events arrive in between
+        pending_yaw   += x_offset;
+        pending_pitch += pitch - previous_pitch;
+        mark_basis_dirty();
     }
 
     // processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
@@ -113,9 +247,81 @@ public:
     }
 
 private:
-    // calculates the front vector from the Camera's (updated) Euler Angles
+    glm::vec3 front{0.f, 0.f, -1.f};
+    glm::vec3 up{0.f, 1.f, 0.f};
+    glm::vec3 right{1.f, 0.f, 0.f};
+
+    // position at the start of the current simulation step
+    glm::vec3 previous_position{0.f};
+    float interpolation_alpha = 1.f;
+
+    camera_orientation orientation_mode = camera_orientation::euler;
+    // camera-to-world rotation in quaternion mode; camera space looks down -z with +y up
+    glm::quat orientation{1.f, 0.f, 0.f, 0.f};
+    // degrees turned since the basis was last rebuilt
+    float pending_yaw = 0.f;
+    float pending_pitch = 0.f;
+    bool basis_dirty = true;
+
+    glm::mat4 view_matrix{1.f};
+    glm::mat4 projection_matrix{1.f};
+    glm::mat4 view_projection_matrix{1.f};
+    bool view_dirty = true;
+    bool view_projection_dirty = true;
+    unsigned int revision = 0;
+
+    void mark_basis_dirty()
+    {
+        basis_dirty = true;
+        mark_view_dirty();
+    }
+
+    void mark_view_dirty()
+    {
+        view_dirty = true;
+        view_projection_dirty = true;
+        revision++;
+    }
+
+    // rotation taking camera space to the orientation given by yaw and pitch: yaw about world_up (-90 looks down -z), then
+    // pitch about the camera's own right axis
+    glm::quat orientation_from_euler() const
+    {
+        return glm::angleAxis(glm::radians(-(yaw + 90.0f)), world_up) * glm::angleAxis(glm::radians(pitch), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+
+    // rebuilds front, right and up if the camera turned since they were last read
     void update_camera_vectors()
     {
+        if (!basis_dirty)
+            return;
+        basis_dirty = false;
+
+        if (orientation_mode == camera_orientation::quaternion)
+        {
+            // turning right is a negative rotation about world_up, applied in world space (on the left) so the horizon stays
+            // level; looking up is a positive rotation about the camera's right axis, applied in camera space (on the right)
+            if (pending_yaw != 0.f)
+                orientation = glm::angleAxis(glm::radians(-pending_yaw), world_up) * orientation;
+            if (pending_pitch != 0.f)
+                orientation = orientation * glm::angleAxis(glm::radians(pending_pitch), glm::vec3(1.0f, 0.0f, 0.0f));
+            pending_yaw = 0.f;
+            pending_pitch = 0.f;
+
+            // renormalize so rounding doesn't accumulate over many turns
+            orientation = glm::normalize(orientation);
+
+            // the basis vectors are the rotated camera axes, i.e. the columns of the quaternion's rotation matrix
+            glm::mat3 rotation = glm::mat3_cast(orientation);
+            right = rotation[0];
+            up    = rotation[1];
+            front = -rotation[2];
+            return;
+        }
+
+        pending_yaw = 0.f;
+        pending_pitch = 0.f;
+
         // calculate the new Front vector
         glm::vec3 front_vec;
         front_vec.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
@@ -0,0 +1,54 @@
+#ifndef CAMERA_UNIFORM_BUFFER_H
+#define CAMERA_UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shaders/Shader.h"
+
+// Holds the view/projection matrices in a single std140 uniform buffer bound at camera_block_binding. Every Shader whose
+// program declares a "Camera" block is linked to that binding point, so one update per frame feeds all of them.
+class CameraUniformBuffer
+{
+public:
+    // std140 layout of the GLSL block: mat4s are four vec4 columns, so the C++ struct matches it with no padding
+    struct block
+    {
+        glm::mat4 projection_matrix;
+        glm::mat4 view_matrix;
+    };
+
+    static_assert(sizeof(block) == 2 * 16 * sizeof(float), "Camera block must match the std140 layout");
+
+    GLuint id;
+
+    CameraUniformBuffer()
+    {
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_UNIFORM_BUFFER, id);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(block), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, camera_block_binding, id);
+    }
+
+    ~CameraUniformBuffer()
+    {
+        glDeleteBuffers(1, &id);
+    }
+
+    CameraUniformBuffer(const CameraUniformBuffer&) = delete;
+    CameraUniformBuffer& operator=(const CameraUniformBuffer&) = delete;
+
+    void update(const glm::mat4& projection_matrix, const glm::mat4& view_matrix) const
+    {
+        const block data{projection_matrix, view_matrix};
+        
+        glBindBuffer(GL_UNIFORM_BUFFER, id);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+};
+
+#endif // CAMERA_UNIFORM_BUFFER_H
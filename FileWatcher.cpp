@@ -0,0 +1,144 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::filesystem::file_time_type write_time(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(path, error);
+
+        return error ? std::filesystem::file_time_type::min() : time;
+    }
+}
+
+FileWatcher::FileWatcher(std::vector<std::string> watched_paths)
+{
+    for (const std::string& path : watched_paths)
+    {
+        std::error_code error;
+        const std::filesystem::path absolute_path = std::filesystem::absolute(path, error);
+
+        paths.push_back(error ? std::filesystem::path(path) : absolute_path.lexically_normal());
+    }
+
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotify_fd != -1)
+    {
+        for (const std::filesystem::path& path : paths)
+        {
+            const std::filesystem::path directory = path.parent_path();
+
+            if (std::find(watched_directories.begin(), watched_directories.end(), directory) != watched_directories.end()) continue;
+
+            // the directory is watched instead of the file: a rename over the file would silently end a watch on the file itself.
+            // No IN_CREATE: a new file is still empty then; its IN_CLOSE_WRITE follows once the contents are in
+            const int watch = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+            if (watch == -1)
+            {
+                close(inotify_fd);
+                inotify_fd = -1;
+                directory_watches.clear();
+                watched_directories.clear();
+                break;
+            }
+
+            directory_watches.push_back(watch);
+            watched_directories.push_back(directory);
+        }
+    }
+#endif
+
+    if (inotify_fd == -1)
+    {
+        for (const std::filesystem::path& path : paths) write_times.push_back(write_time(path));
+
+        next_check = std::chrono::steady_clock::now() + check_interval;
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (inotify_fd != -1) close(inotify_fd);
+#endif
+}
+
+bool FileWatcher::poll()
+{
+#ifdef __linux__
+    if (inotify_fd != -1)
+    {
+        bool changed = false;
+        alignas(inotify_event) char buffer[4096];
+
+        // drain everything queued since the last call; one frame's worth of events is reported as a single change
+        for (;;)
+        {
+            const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+
+            if (length <= 0) break;
+
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->len == 0) continue;
+
+                const auto directory = std::find(directory_watches.begin(), directory_watches.end(), event->wd);
+
+                if (directory != directory_watches.end() && is_watched(watched_directories[directory - directory_watches.begin()], event->name))
+                {
+                    changed = true;
+                }
+            }
+        }
+
+        return changed;
+    }
+#endif
+
+    return poll_write_times();
+}
+
+bool FileWatcher::is_watched(const std::filesystem::path& directory, const char* file_name) const
+{
+    const std::filesystem::path path = directory / file_name;
+
+    return std::find(paths.begin(), paths.end(), path) != paths.end();
+}
+
+bool FileWatcher::poll_write_times()
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now < next_check) return false;
+
+    next_check = now + check_interval;
+
+    bool changed = false;
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        const auto time = write_time(paths[i]);
+
+        if (time != write_times[i])
+        {
+            write_times[i] = time;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
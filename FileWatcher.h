@@ -0,0 +1,42 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Reports writes to a fixed set of files without ever blocking. On Linux it listens to inotify events on the files' directories,
+// which also catches editors that save by writing a new file and renaming it over the old one; elsewhere it compares
+// modification times a few times per second.
+class FileWatcher
+{
+public:
+    explicit FileWatcher(std::vector<std::string> paths);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // true if any watched file was closed after writing (new files included) or renamed into place since the last call
+    bool poll();
+
+private:
+    std::vector<std::filesystem::path> paths;
+
+    // inotify descriptor and one watch per distinct parent directory; -1 where inotify isn't available
+    int inotify_fd = -1;
+    std::vector<int> directory_watches;
+    std::vector<std::filesystem::path> watched_directories;
+
+    // fallback: last seen modification time of each path, rechecked at most every check_interval
+    std::vector<std::filesystem::file_time_type> write_times;
+    std::chrono::steady_clock::time_point next_check;
+
+    static constexpr std::chrono::milliseconds check_interval{250};
+
+    bool is_watched(const std::filesystem::path& directory, const char* file_name) const;
+    bool poll_write_times();
+};
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,83 @@
+#include "Frustum.h"
+
+#include <limits>
+
+#include "simd_math.h"
+
+namespace
+{
+    template <typename V>
+    size_t cull_batch(const frustum& view_frustum, const float* x, const float* y, const float* z, const float radius, const size_t begin, uint32_t* visible_indices, size_t visible_count)
+    {
+        const V px = V::load(x + begin);
+        const V py = V::load(y + begin);
+        const V pz = V::load(z + begin);
+
+        // a sphere is outside as soon as its centre is more than radius behind any single plane
+        V nearest = V::broadcast(radius);
+
+        for (const glm::vec4& plane : view_frustum.planes)
+        {
+            const V distance = V::broadcast(plane.x) * px + V::broadcast(plane.y) * py + V::broadcast(plane.z) * pz + V::broadcast(plane.w);
+            nearest = min(nearest, distance);
+        }
+
+        int visible_mask = greater_equal_mask(nearest, V::broadcast(-radius));
+
+        while (visible_mask)
+        {
+            int lane = 0;
+            
+            while (!(visible_mask & (1 << lane))) lane++;
+
+            visible_indices[visible_count++] = static_cast<uint32_t>(begin + lane);
+            visible_mask &= visible_mask - 1;
+        }
+
+        return visible_count;
+    }
+}
+
+frustum extract_frustum(const glm::mat4& view_projection, const clip_depth_range depth_range)
+{
+    // glm is column-major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const auto row = [&view_projection](const int i)
+    {
+        return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+
+    const glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+    // the depth planes are -w <= z <= w, or 0 <= z <= w for a [0, 1] depth range
+    const glm::vec4 depth_minimum = depth_range == clip_depth_range::zero_to_one ? z : w + z;
+
+    frustum result{{w + x, w - x, w + y, w - y, depth_minimum, w - z}};
+
+    for (glm::vec4& plane : result.planes)
+    {
+        const float normal_length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+
+        // an infinite far plane comes out as (0, 0, 0, d > 0): nothing is ever behind it
+        plane = normal_length > 0.f ? plane / normal_length : glm::vec4(0.f, 0.f, 0.f, std::numeric_limits<float>::max());
+    }
+
+    return result;
+}
+
+size_t cull_spheres(const frustum& view_frustum, const float* x, const float* y, const float* z, const float radius, const size_t count, uint32_t* visible_indices)
+{
+    size_t visible_count = 0;
+    size_t i = 0;
+
+    for (; i + f32xn::lanes <= count; i += f32xn::lanes)
+    {
+        visible_count = cull_batch<f32xn>(view_frustum, x, y, z, radius, i, visible_indices, visible_count);
+    }
+
+    for (; i < count; i++)
+    {
+        visible_count = cull_batch<f32x1>(view_frustum, x, y, z, radius, i, visible_indices, visible_count);
+    }
+
+    return visible_count;
+}
@@ -0,0 +1,36 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// The six clip planes of a view-projection matrix as (normal, distance) with unit-length normals pointing inwards,
+// so dot(normal, point) + distance is the signed world-space distance of a point to each plane
+struct frustum
+{
+    glm::vec4 planes[6];
+};
+
+struct culling_stats
+{
+    size_t submitted = 0;
+    size_t culled = 0;
+};
+
+enum class clip_depth_range : uint8_t
+{
+    negative_one_to_one, // OpenGL's default
+    zero_to_one          // glClipControl(..., GL_ZERO_TO_ONE), used by reverse-Z projections
+};
+
+// Gribb-Hartmann plane extraction. A projection without a far plane (an infinite one) yields a plane every point is inside.
+frustum extract_frustum(const glm::mat4& view_projection, clip_depth_range depth_range = clip_depth_range::negative_one_to_one);
+
+// Tests `count` bounding spheres of equal radius, centred at (x[i], y[i], z[i]), against the frustum several at a time and
+// writes the indices of the ones that intersect it, in order, to visible_indices (which must have room for count entries).
+// Returns the number of visible spheres.
+size_t cull_spheres(const frustum& view_frustum, const float* x, const float* y, const float* z, float radius, size_t count, uint32_t* visible_indices);
+
+#endif // FRUSTUM_H
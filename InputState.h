@@ -0,0 +1,83 @@
+#ifndef INPUT_STATE_H
+#define INPUT_STATE_H
+
+#include <bitset>
+
+#include <GLFW/glfw3.h>
+
+// Everything the window reported since the previous snapshot, consumed once per frame
+struct input_snapshot
+{
+    // cursor movement in screen units, y pointing up
+    float cursor_x_offset = 0.f;
+    float cursor_y_offset = 0.f;
+    float scroll_y_offset = 0.f;
+
+    // keys held down when the snapshot was taken
+    std::bitset<GLFW_KEY_LAST + 1> keys_down;
+
+    bool is_key_down(const int key) const
+    {
+        return key >= 0 && key <= GLFW_KEY_LAST && keys_down.test(static_cast<size_t>(key));
+    }
+};
+
+// Collects input events from the GLFW callbacks between snapshots. A cursor event only records the latest position, so
+// however many of them arrive in a frame, the camera turns once, by the difference to the position at the previous
+// snapshot; key state is kept up to date from key events instead of being polled.
+class InputState
+{
+public:
+    void set_cursor_position(const double x, const double y)
+    {
+        // the first position only becomes the reference, so the camera doesn't jump when the cursor is captured
+        if (!has_cursor_position)
+        {
+            snapshot_cursor_x = x;
+            snapshot_cursor_y = y;
+            has_cursor_position = true;
+        }
+
+        cursor_x = x;
+        cursor_y = y;
+    }
+
+    void add_scroll(const double y_offset)
+    {
+        scroll_y_offset += y_offset;
+    }
+
+    void set_key(const int key, const bool down)
+    {
+        // GLFW_KEY_UNKNOWN (-1) and anything else out of range is ignored
+        if (key < 0 || key > GLFW_KEY_LAST) return;
+
+        current.keys_down.set(static_cast<size_t>(key), down);
+    }
+
+    // the input since the previous call; valid until the next one
+    const input_snapshot& take_snapshot()
+    {
+        current.cursor_x_offset = static_cast<float>(cursor_x - snapshot_cursor_x);
+        // inverted: screen y grows downwards, pitch grows upwards
+        current.cursor_y_offset = static_cast<float>(snapshot_cursor_y - cursor_y);
+        current.scroll_y_offset = static_cast<float>(scroll_y_offset);
+
+        snapshot_cursor_x = cursor_x;
+        snapshot_cursor_y = cursor_y;
+        scroll_y_offset = 0.0;
+
+        return current;
+    }
+
+private:
+    input_snapshot current;
+
+    // positions stay doubles: with raw motion they are unbounded, and only their differences are small
+    double cursor_x = 0.0, cursor_y = 0.0;
+    double snapshot_cursor_x = 0.0, snapshot_cursor_y = 0.0;
+    bool has_cursor_position = false;
+    double scroll_y_offset = 0.0;
+};
+
+#endif // INPUT_STATE_H
@@ -1,18 +1,37 @@
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include "stb_image.h"
-
 #include "./utils.h"
+#include "gl_extensions.h"
 #include "shaders/Shader.h"
+#include "shaders/ShaderHotReload.h"
+#include "shaders/ShaderVariants.h"
 #include "Camera.h"
-
-float delta_time = 0.0f;
-float last_frame = 0.0f;
+#include "Frustum.h"
+#include "Viewport.h"
+#include "CameraUniformBuffer.h"
+#include "Mesh.h"
+#include "TransformStore.h"
+#include "alloc_tracking.h"
+#include "benchmark.h"
+#include "headless_context.h"
+#include "InputState.h"
+#include "OffscreenFramebuffer.h"
+#include "SimulationClock.h"
+#include "textures/CookedTexture.h"
+#include "textures/TextureRegistry.h"
 
 enum class shader_type : uint8_t
 {
@@ -20,48 +39,288 @@ enum class shader_type : uint8_t
     fragment
 };
 
+// per_draw issues one draw call per cube; instanced uploads every model matrix into an instance buffer and draws the whole field at once
+enum class render_mode : uint8_t
+{
+    per_draw,
+    instanced
+};
+
+// how per-draw uniforms are set: through handles resolved once, or looked up by name on every call
+enum class uniform_path : uint8_t
+{
+    handle,
+    name
+};
+
+// unaccelerated, unscaled mouse deltas for camera look, where the platform supports them
+constexpr bool use_raw_mouse_motion = true;
+
+// skip instances whose bounding sphere is entirely outside the view frustum before anything is uploaded or drawn
+constexpr bool use_frustum_culling = true;
+
+// frames to let lazily-allocated state settle before debug builds assert the loop stops allocating
+constexpr unsigned int allocation_warmup_frames = 3;
+
+constexpr int window_width = 800;
+constexpr int window_height = 600;
+
+// movement and animation advance in fixed steps of this length, whatever the frame rate
+constexpr int64_t simulation_step_nanoseconds = SimulationClock::default_step_nanoseconds;
+
+// every spinning cube turns at this rate, so the whole field repeats after one period
+constexpr int64_t cube_spin_degrees_per_second = 25;
+constexpr int64_t cube_spin_period_nanoseconds = 360 * int64_t{1000000000} / cube_spin_degrees_per_second;
+
+// benchmark frames left out of the statistics while caches, driver state and clocks settle
+constexpr unsigned int benchmark_warmup_frames = 10;
+
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 
+// filled by the window callbacks between frames, read once per frame through take_snapshot()
+InputState input;
+
+// written by the framebuffer resize callback, applied by the render loop
+Viewport viewport(window_width, window_height);
+
 namespace
 {
+    struct launch_options
+    {
+        bool headless = false;
+        bool benchmark = false;
+        bool reverse_z = false;
+        unsigned int frame_count = 300;
+        std::string output_path;
+        std::string benchmark_output_path = "benchmark_results.json";
+        std::string cook_source_path;
+        std::string cook_destination_path;
+        cook_compression cook_format = cook_compression::automatic;
+        std::string mip_benchmark_path;
+        std::string compression_benchmark_path;
+        bool math_benchmark = false;
+        render_mode cube_render_mode = render_mode::instanced;
+        uniform_path model_matrix_path = uniform_path::handle;
+    };
+
+    const char* render_mode_name(const render_mode mode)
+    {
+        return mode == render_mode::instanced ? "instanced" : "per-draw";
+    }
+
+    const char* uniform_path_name(const uniform_path path)
+    {
+        return path == uniform_path::handle ? "handle" : "name";
+    }
+
+    // LearningOpenGL [--headless] [--benchmark [results.json]] [--frames N] [--output image.ppm] [--reverse-z]
+    //                [--render-mode instanced|per-draw] [--uniform-path handle|name]
+    // LearningOpenGL --cook image.png [image.ctex] [--cook-format auto|none|bc1|bc3|bc7]
+    // LearningOpenGL --mip-benchmark image.png [--frames N]
+    // LearningOpenGL --compression-benchmark image.png [--frames N]
+    // LearningOpenGL --math-benchmark [--frames N]
+    launch_options parse_launch_options(const int argc, char* argv[])
+    {
+        launch_options options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--headless") == 0)
+            {
+                options.headless = true;
+            }
+            else if (std::strcmp(argv[i], "--benchmark") == 0)
+            {
+                options.benchmark = true;
+
+                if (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0)
+                {
+                    options.benchmark_output_path = argv[++i];
+                }
+            }
+            else if (std::strcmp(argv[i], "--reverse-z") == 0)
+            {
+                options.reverse_z = true;
+            }
+            else if (std::strcmp(argv[i], "--render-mode") == 0 && i + 1 < argc)
+            {
+                const char* mode = argv[++i];
+
+                if (std::strcmp(mode, "instanced") == 0) options.cube_render_mode = render_mode::instanced;
+                else if (std::strcmp(mode, "per-draw") == 0) options.cube_render_mode = render_mode::per_draw;
+                else std::cout << "Ignoring unknown render mode: " << mode << '\n';
+            }
+            else if (std::strcmp(argv[i], "--uniform-path") == 0 && i + 1 < argc)
+            {
+                // only the per-draw mode sets a uniform per cube, so this makes no difference to instanced runs
+                const char* path = argv[++i];
+
+                if (std::strcmp(path, "handle") == 0) options.model_matrix_path = uniform_path::handle;
+                else if (std::strcmp(path, "name") == 0) options.model_matrix_path = uniform_path::name;
+                else std::cout << "Ignoring unknown uniform path: " << path << '\n';
+            }
+            else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            {
+                options.frame_count = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            {
+                options.output_path = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--cook") == 0 && i + 1 < argc)
+            {
+                options.cook_source_path = argv[++i];
+                options.cook_destination_path = cooked_texture_path(options.cook_source_path);
+
+                if (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0)
+                {
+                    options.cook_destination_path = argv[++i];
+                }
+            }
+            else if (std::strcmp(argv[i], "--cook-format") == 0 && i + 1 < argc)
+            {
+                if (!parse_cook_compression(argv[++i], options.cook_format))
+                {
+                    std::cout << "Ignoring unknown cook format: " << argv[i] << '\n';
+                }
+            }
+            else if (std::strcmp(argv[i], "--mip-benchmark") == 0 && i + 1 < argc)
+            {
+                options.mip_benchmark_path = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--compression-benchmark") == 0 && i + 1 < argc)
+            {
+                options.compression_benchmark_path = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--math-benchmark") == 0)
+            {
+                options.math_benchmark = true;
+            }
+            else
+            {
+                std::cout << "Ignoring unknown argument: " << argv[i] << '\n';
+            }
+        }
+
+        return options;
+    }
+    
     void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     {
-        glViewport(0, 0, width, height);
+        viewport.resize(width, height);
     }
 }
 
 int main(int argc, char* argv[])
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    const launch_options options = parse_launch_options(argc, argv);
 
-    GLFWwindow* window = glfwCreateWindow(800, 600, "LearnOpenGL", nullptr, nullptr);
+    // offline asset steps: no window or GL context involved
+    if (!options.cook_source_path.empty())
+    {
+        return cook_texture(options.cook_source_path, options.cook_destination_path, options.cook_format) ? 0 : 1;
+    }
 
-    if (!window)
+    if (!options.mip_benchmark_path.empty())
     {
-        std::cout << "Failed to create GLFW window" << '\n';
-        glfwTerminate();
-        return -1;
+        return run_mip_benchmark(options.mip_benchmark_path, options.frame_count) ? 0 : 1;
     }
 
-    glfwMakeContextCurrent(window);
+    if (!options.compression_benchmark_path.empty())
+    {
+        return run_compression_benchmark(options.compression_benchmark_path, options.frame_count) ? 0 : 1;
+    }
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (options.math_benchmark)
     {
-        std::cout << "Failed to initialize GLAD" << '\n';
-        glfwTerminate();
-        return -1;
+        return run_math_benchmark(options.frame_count) ? 0 : 1;
     }
+    
+    GLFWwindow* window = nullptr;
 
-    glViewport(0, 0, 800, 600);
+    if (options.headless)
+    {
+        // no window system at all: EGL surfaceless context, scene rendered into an FBO
+        if (!create_headless_context())
+        {
+            std::cout << "Failed to create headless context" << '\n';
+            return -1;
+        }
 
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+        if (!gladLoadGLLoader(headless_get_proc_address))
+        {
+            std::cout << "Failed to initialize GLAD" << '\n';
+            destroy_headless_context();
+            return -1;
+        }
+    }
+    else
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(window_width, window_height, "LearnOpenGL", nullptr, nullptr);
+
+        if (!window)
+        {
+            std::cout << "Failed to create GLFW window" << '\n';
+            glfwTerminate();
+            return -1;
+        }
+
+        glfwMakeContextCurrent(window);
+
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << '\n';
+            glfwTerminate();
+            return -1;
+        }
+
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // benchmark runs are driven by the scripted camera path only, and must not be capped by vsync
+        if (options.benchmark)
+        {
+            glfwSwapInterval(0);
+        }
+        else
+        {
+            glfwSetCursorPosCallback(window, mouse_callback);
+            glfwSetScrollCallback(window, scroll_callback);
+            glfwSetKeyCallback(window, key_callback);
+
+#ifdef GLFW_RAW_MOUSE_MOTION
+            // only takes effect while the cursor is disabled, which it is for the whole run
+            if (use_raw_mouse_motion && glfwRawMouseMotionSupported())
+            {
+                glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+            }
+#endif
+        }
+    }
+
+    set_gl_function_loader(options.headless ? headless_get_proc_address : (GLADloadproc)glfwGetProcAddress);
+
+    if (options.reverse_z && !viewport.enable_reverse_z())
+    {
+        std::cout << "ERROR::VIEWPORT::REVERSE_Z_UNSUPPORTED: needs GL_ARB_clip_control, using the standard projection" << '\n';
+    }
+
+    // headless runs have no default framebuffer, so the whole scene renders into this one instead
+    std::unique_ptr<OffscreenFramebuffer> offscreen_framebuffer;
+
+    if (options.headless)
+    {
+        const GLenum depth_format = viewport.get_depth_mode() == depth_mode::reverse_z_infinite ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+
+        offscreen_framebuffer = std::make_unique<OffscreenFramebuffer>(window_width, window_height, depth_format);
+        offscreen_framebuffer->bind();
+    }
     
     
     float vertices[] = {
@@ -108,7 +367,7 @@ int main(int argc, char* argv[])
         -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
     };
 
-    glm::vec3 cube_positions[] = {
+    std::vector<glm::vec3> cube_positions = {
         glm::vec3( 0.0f,  0.0f,  0.0f), 
         glm::vec3( 2.0f,  5.0f, -15.0f), 
         glm::vec3(-1.5f, -2.2f, -2.5f),  
@@ -121,80 +380,41 @@ int main(int argc, char* argv[])
         glm::vec3(-1.3f,  1.0f, -1.5f)  
     };
 
-    unsigned int indices[] = {  // note that we start from 0!
-        0, 1, 3,  // first Triangle
-        1, 2, 3   // second Triangle
-    };
+    // weld the 36 expanded vertices down to the unique position/uv pairs so the post-transform vertex cache gets hits
+    const indexed_mesh cube_mesh = build_indexed_mesh(vertices, sizeof(vertices) / (5 * sizeof(float)), 5);
+    const auto cube_index_count = static_cast<GLsizei>(cube_mesh.indices.size());
+    const float cube_bounding_radius = bounding_sphere_radius(cube_mesh);
     
     // create Vertex Array Object to easily recover vertex attribute configurations of a Vertex Buffer Object when issuing a render call
-    GLuint vao, vbo, ebo;
-    GLuint container_texture, face_texture;
+    GLuint vao, vbo, ebo, instance_vbo;
     
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
+    glGenBuffers(1, &instance_vbo);
 
     glBindVertexArray(vao);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     // transfer indices data to the GPU memory
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(cube_mesh.indices.size() * sizeof(uint16_t)), cube_mesh.indices.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // load textures
-    stbi_set_flip_vertically_on_load(true);
-    int img_width, img_height, img_channels;
-
-    // container texture
-    glGenTextures(1, &container_texture);
-    
-    glBindTexture(GL_TEXTURE_2D, container_texture);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(cube_mesh.vertices.size() * sizeof(float)), cube_mesh.vertices.data(), GL_STATIC_DRAW);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // load textures: decoded on worker threads and packed as layers of one texture array per image size, so the
+    // whole material set is a single bind and the shader picks images by layer index
+    std::optional<TextureRegistry> textures;
+    textures.emplace();
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    unsigned char* container_image_data = load_image("./assets/container.jpg", img_width, img_height, img_channels);
+    const std::vector<texture_layer> material_layers = textures->acquire_layers({"./assets/container.jpg", "./assets/awesomeface.png"});
+    const texture_layer container_layer = material_layers[0];
+    const texture_layer face_layer = material_layers[1];
 
-    if (container_image_data)
+    if (container_layer.array != face_layer.array)
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img_width, img_height, 0, GL_RGB, GL_UNSIGNED_BYTE, container_image_data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        std::cout << "ERROR::TEXTURE::MATERIAL_LAYERS_NOT_SHARED: container and face images differ in size" << '\n';
     }
-    else
-    {
-        std::cout << "Failed to load container image" << '\n';
-    }
-
-    // face texture
-    glGenTextures(1, &face_texture);
-    
-    glBindTexture(GL_TEXTURE_2D, face_texture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    
-    unsigned char* face_image_data = load_image("./assets/awesomeface.png", img_width, img_height, img_channels);
-
-    if (face_image_data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img_width, img_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, face_image_data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load face image" << '\n';
-    }
-
-    stbi_image_free(face_image_data);
-    stbi_image_free(container_image_data);
     
     // bind data to the vao
     glBindVertexArray(vao);
@@ -213,6 +433,36 @@ int main(int argc, char* argv[])
     // vertex texture coordinate
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+
+    // per-instance model matrix: a mat4 attribute takes 4 consecutive locations (2 to 5), one vec4 column each,
+    // and a divisor of 1 advances it once per instance instead of once per vertex
+    // even cubes keep a fixed 20 * i degree tilt, odd ones spin at 25 degrees per second, all around the same (1, 0, 0.5) axis
+    TransformStore cube_transforms;
+    cube_transforms.reserve(cube_positions.size());
+
+    for (unsigned int i = 0; i < cube_positions.size(); i++)
+    {
+        const bool spinning = i % 2 != 0;
+        
+        cube_transforms.add(cube_positions[i], glm::vec3(1.f, 0.f, 0.5f), spinning ? 0.f : glm::radians(20.f * static_cast<float>(i)), spinning ? glm::radians(static_cast<float>(cube_spin_degrees_per_second)) : 0.f);
+    }
+    
+    std::vector<glm::mat4> instance_model_matrices(cube_transforms.size());
+
+    // indices of the cubes that survived culling this frame, and their matrices packed together for the instance buffer
+    std::vector<uint32_t> visible_cube_indices(cube_transforms.size());
+    std::vector<glm::mat4> visible_model_matrices(cube_transforms.size());
+    culling_stats cube_culling_stats;
+    
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instance_model_matrices.size() * sizeof(glm::mat4)), nullptr, GL_STREAM_DRAW);
+
+    for (GLuint column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(2 + column);
+        glVertexAttribDivisor(2 + column, 1);
+    }
     
     // note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -226,32 +476,124 @@ int main(int argc, char* argv[])
     
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     
-    const Shader shader{"./shaders/vertex.glsl", "./shaders/fragment.glsl"};
+    // linked programs are kept on disk between runs, so only the first run after a shader or driver change compiles GLSL
+    const ProgramBinaryCache program_binaries("./shader_cache");
+
+    const char* vertex_shader_path = options.cube_render_mode == render_mode::instanced ? "./shaders/vertex_instanced.glsl" : "./shaders/vertex.glsl";
+    const char* fragment_shader_path = "./shaders/fragment.glsl";
+
+    // material constants are compiled into the program instead of being uniforms
+    const shader_defines material_defines = {{"FACE_MIX", "0.2"}, {"FACE_USE_ALPHA", "0"}};
+
+    ShaderVariants shader_variants(&program_binaries);
+    Shader& shader = shader_variants.get(vertex_shader_path, fragment_shader_path, material_defines);
+
+    // material bindings live in the program, so they are set again whenever a reload swaps it
+    const auto set_material_uniforms = [&]
+    {
+        shader.use();
+        shader.set_int("material_textures", 0);
+        shader.set_int("container_layer", container_layer.layer);
+        shader.set_int("face_layer", face_layer.layer);
+    };
+
+    set_material_uniforms();
 
-    shader.use();
-    shader.set_int("container_texture", 0);
-    shader.set_int("face_texture", 1);
+    // interactive runs pick up saved shader edits; fixed-length runs always render with the program they started with
+    std::optional<ShaderHotReload> shader_reload;
+
+    if (!options.headless && !options.benchmark)
+    {
+        shader_reload.emplace(vertex_shader_path, fragment_shader_path, material_defines, &program_binaries);
+    }
+
+    // bound once for the whole run: texture uploads go through a unit of their own and never disturb it
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, container_layer.array);
+
+    auto model_matrix_uniform = shader.get_uniform<glm::mat4>("model_matrix");
+
+    // view/projection live in one buffer shared by every program instead of being uploaded to each of them
+    std::optional<CameraUniformBuffer> camera_uniforms;
+    camera_uniforms.emplace();
+
+    // cursor events only add up yaw/pitch deltas; the basis is rebuilt from the quaternion once per frame when it's read
+    camera.set_orientation_mode(camera_orientation::quaternion);
+
+    // revision of the camera the uniform buffer and frustum were last built from; starts out of date
+    unsigned int camera_revision = camera.get_revision() - 1;
+    frustum view_frustum{};
 
     glEnable(GL_DEPTH_TEST);
     
-    while (!glfwWindowShouldClose(window))
+    unsigned int frame_index = 0;
+
+    const bool fixed_frame_count = options.headless || options.benchmark;
+
+    // fixed-length runs have to render the same frames every time, so they can't start before every texture is resident
+    if (fixed_frame_count)
     {
-        float current_frame = static_cast<float>(glfwGetTime());
+        textures->finish_all();
+    }
+
+    // reserved up front so recording a frame time never allocates inside the loop
+    std::vector<double> benchmark_frame_times_ms;
+
+    if (options.benchmark)
+    {
+        benchmark_frame_times_ms.reserve(options.frame_count);
+    }
+    
+    SimulationClock simulation_clock(simulation_step_nanoseconds);
+
+    while (fixed_frame_count ? frame_index < options.frame_count && !(window && glfwWindowShouldClose(window)) : !glfwWindowShouldClose(window))
+    {
+        // rebuilding and swapping a program allocates, so reloads happen before the frame's allocation count is taken
+        const bool program_swapped = shader_reload && shader_reload->update(shader);
+
+        if (program_swapped)
+        {
+            set_material_uniforms();
+            model_matrix_uniform = shader.get_uniform<glm::mat4>("model_matrix");
+        }
+
+        [[maybe_unused]] const size_t allocations_at_frame_start = heap_allocation_count();
+        const auto frame_start = std::chrono::steady_clock::now();
+        
+        // headless and benchmark frames advance exactly one step each so repeated runs render identical images
+        if (fixed_frame_count) simulation_clock.advance(simulation_step_nanoseconds);
+        else simulation_clock.advance_to(SimulationClock::now());
+
+        // every event since the previous frame, coalesced: the camera turns once however many cursor events arrived
+        const input_snapshot& frame_input = input.take_snapshot();
+
+        if (window && !options.benchmark)
+        {
+            process_cursor_input(frame_input);
+        }
+
+        while (simulation_clock.step())
+        {
+            camera.begin_simulation_step();
 
-        delta_time = current_frame - last_frame;
-        last_frame = current_frame;
+            if (options.benchmark)
+            {
+                apply_benchmark_camera_path(camera, static_cast<unsigned int>(simulation_clock.get_tick() - 1), simulation_clock.get_step_seconds());
+            }
+            else if (window)
+            {
+                process_input(frame_input, simulation_clock.get_step_seconds());
+            }
+        }
+
+        // rendered between the last two simulated states, so motion stays smooth when frames and steps don't line up
+        camera.set_render_interpolation(simulation_clock.get_interpolation_alpha());
         
-        process_input(window);
+        textures->update();
         
         glClearColor(0.5f, 0.867f, 0.949f, 1.f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, container_texture);
-        
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, face_texture);
-        
         shader.use();
         glBindVertexArray(vao);
         
@@ -281,29 +623,73 @@ int main(int argc, char* argv[])
         // glm::mat4 view_matrix = glm::lookAt(camera_position, camera_position + camera_front, camera_up);
         
         // view_matrix = glm::translate(view_matrix, glm::vec3(0.f, 0.f, -3.f));
-        glm::mat4 projection_matrix = glm::perspective(glm::radians(camera.zoom), 800.f / 600.f, 0.1f, 100.f);
-        shader.set_mat4("projection_matrix", projection_matrix);
+        // rebuilt only on the frames the zoom or the framebuffer size changed
+        viewport.set_field_of_view(camera.zoom);
 
-        // glm::mat4 view_matrix = camera.get_view_matrix();
-        glm::mat4 view_matrix = my_look_at(glm::vec3(camera.position.x, camera.position.y, camera.position.z), camera.position + camera.front, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.set_mat4("view_matrix", view_matrix);
+        if (viewport.apply())
+        {
+            camera.set_projection_matrix(viewport.get_projection_matrix());
+        }
+
+        // glm::mat4 view_matrix = my_look_at(glm::vec3(camera.position.x, camera.position.y, camera.position.z), camera.position + camera.front, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // the uniform buffer and the frustum planes only change with the camera; a still camera costs nothing here
+        if (camera.get_revision() != camera_revision)
+        {
+            camera_uniforms->update(camera.get_projection_matrix(), camera.get_view_matrix());
+            view_frustum = extract_frustum(camera.get_view_projection_matrix(), viewport.get_clip_depth_range());
+            camera_revision = camera.get_revision();
+        }
         
-        for (unsigned int i = 0; i < 10; i++)
+        // the cube spin is a function of time, so interpolating it is evaluating it at the interpolated time. The kernel works
+        // in float, so the time is reduced to one spin period while still exact; it stays below 14.4 s however long the run
+        const auto time = static_cast<float>(static_cast<double>(simulation_clock.get_render_time_nanoseconds() % cube_spin_period_nanoseconds) * 1e-9);
+        const auto cube_count = static_cast<unsigned int>(cube_transforms.size());
+
+        cube_transforms.compute_model_matrices(time, instance_model_matrices.data());
+
+        size_t visible_cube_count = cube_count;
+
+        if (use_frustum_culling)
         {
-            glm::mat4 model_matrix = glm::mat4(1.f);
-            model_matrix = glm::translate(model_matrix, cube_positions[i]);
-            
-            float angle = 20.f * static_cast<float>(i);
+            visible_cube_count = cull_spheres(view_frustum, cube_transforms.positions_x(), cube_transforms.positions_y(), cube_transforms.positions_z(), cube_bounding_radius, cube_count, visible_cube_indices.data());
+        }
+        else
+        {
+            for (unsigned int i = 0; i < cube_count; i++) visible_cube_indices[i] = i;
+        }
 
-            if (i % 2 != 0)
+        cube_culling_stats.submitted += visible_cube_count;
+        cube_culling_stats.culled += cube_count - visible_cube_count;
+        
+        if (options.cube_render_mode == render_mode::instanced)
+        {
+            for (size_t i = 0; i < visible_cube_count; i++)
             {
-                angle = (float)glfwGetTime() * 25.f;
+                visible_model_matrices[i] = instance_model_matrices[visible_cube_indices[i]];
             }
             
-            model_matrix = glm::rotate(model_matrix, glm::radians(angle), glm::vec3(1.f, 0.f, 0.5f));
-            shader.set_mat4("model_matrix", model_matrix);
+            // orphan the previous storage so the driver doesn't stall waiting for last frame's draw to finish reading it
+            const auto instance_data_size = static_cast<GLsizeiptr>(visible_model_matrices.size() * sizeof(glm::mat4));
+            
+            glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+            glBufferData(GL_ARRAY_BUFFER, instance_data_size, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(visible_cube_count * sizeof(glm::mat4)), visible_model_matrices.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glDrawElementsInstanced(GL_TRIANGLES, cube_index_count, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(visible_cube_count));
+        }
+        else
+        {
+            for (size_t i = 0; i < visible_cube_count; i++)
+            {
+                const glm::mat4& model_matrix = instance_model_matrices[visible_cube_indices[i]];
+                
+                if (options.model_matrix_path == uniform_path::handle) shader.set(model_matrix_uniform, model_matrix);
+                else shader.set_mat4("model_matrix", model_matrix);
+
+                glDrawElements(GL_TRIANGLES, cube_index_count, GL_UNSIGNED_SHORT, nullptr);
+            }
         }
         
         /*
@@ -317,14 +703,71 @@ int main(int argc, char* argv[])
         
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
             */
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // steady-state frames must not touch the heap (only counted in debug builds); the first draws with a swapped-in program
+        // may still finish compiling it inside the driver
+        assert(frame_index < allocation_warmup_frames || program_swapped || heap_allocation_count() == allocations_at_frame_start);
+        frame_index++;
+        
+        if (window)
+        {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        if (options.benchmark && frame_index > benchmark_warmup_frames)
+        {
+            const std::chrono::duration<double, std::milli> frame_time = std::chrono::steady_clock::now() - frame_start;
+            benchmark_frame_times_ms.push_back(frame_time.count());
+        }
+    }
+
+    if (options.benchmark)
+    {
+        const frame_time_stats stats = compute_frame_time_stats(benchmark_frame_times_ms);
+        
+        print_frame_time_stats(stats);
+
+        benchmark_configuration configuration;
+        configuration.render_mode = render_mode_name(options.cube_render_mode);
+        configuration.uniform_path = uniform_path_name(options.model_matrix_path);
+
+        std::cout << "render mode: " << configuration.render_mode << " | uniform path: " << configuration.uniform_path
+            << " | cubes submitted: " << cube_culling_stats.submitted << " | culled: " << cube_culling_stats.culled << '\n';
+
+        if (!write_frame_time_stats_json(options.benchmark_output_path, stats, configuration, cube_culling_stats))
+        {
+            std::cout << "Failed to write " << options.benchmark_output_path << '\n';
+        }
+    }
+
+    if (offscreen_framebuffer && !options.output_path.empty())
+    {
+        const std::vector<unsigned char> pixels = offscreen_framebuffer->read_pixels();
+
+        if (!write_ppm(options.output_path, pixels.data(), window_width, window_height))
+        {
+            std::cout << "Failed to write " << options.output_path << '\n';
+        }
     }
 
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
+    glDeleteBuffers(1, &instance_vbo);
+
+    // GL objects have to go before the context they belong to
+    camera_uniforms.reset();
+    textures.reset();
+    offscreen_framebuffer.reset();
+
+    if (options.headless)
+    {
+        destroy_headless_context();
+    }
+    else
+    {
+        glfwTerminate();
+    }
     
-    glfwTerminate();
     return 0;
 }
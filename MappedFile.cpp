@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER file_size;
+
+    if (GetFileSizeEx(file, &file_size))
+    {
+        length = static_cast<size_t>(file_size.QuadPart);
+        open = true;
+
+        // zero-length files can't be mapped, but they are valid (empty) files
+        if (length > 0)
+        {
+            const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (mapping)
+            {
+                bytes = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+
+            open = bytes != nullptr;
+        }
+    }
+
+    CloseHandle(file);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (file < 0) return;
+
+    struct stat file_status {};
+
+    if (fstat(file, &file_status) == 0)
+    {
+        length = static_cast<size_t>(file_status.st_size);
+        open = true;
+
+        if (length > 0)
+        {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+
+            if (mapping != MAP_FAILED)
+            {
+                bytes = static_cast<const unsigned char*>(mapping);
+                
+                // assets are read front to back exactly once, so ask for aggressive read-ahead; advice values aren't flags
+                // that can be or-ed together, so each takes its own call
+                madvise(mapping, length, MADV_SEQUENTIAL);
+                madvise(mapping, length, MADV_WILLNEED);
+            }
+
+            open = bytes != nullptr;
+        }
+    }
+
+    // the mapping keeps its own reference to the file
+    ::close(file);
+#endif
+
+    if (!open) length = 0;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)), open(std::exchange(other.open, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        open = std::exchange(other.open, false);
+    }
+
+    return *this;
+}
+
+void MappedFile::close()
+{
+    if (bytes)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+    }
+
+    bytes = nullptr;
+    length = 0;
+    open = false;
+}
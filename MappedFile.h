@@ -0,0 +1,51 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Non-owning view of a byte range; valid only as long as whatever owns the bytes
+struct byte_span
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+};
+
+// Read-only memory mapping of a whole file, the one way assets are read from disk. The bytes are paged in by the OS on first
+// touch and never copied into the process heap; spans and views handed out stay valid for as long as the MappedFile lives.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file couldn't be opened or mapped; an empty file is open with size() == 0
+    bool is_open() const { return open; }
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    byte_span span() const { return {bytes, length}; }
+
+    // the file as text, e.g. shader source; not null-terminated
+    std::string_view text() const { return bytes ? std::string_view(reinterpret_cast<const char*>(bytes), length) : std::string_view(); }
+
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+    bool open = false;
+
+    void close();
+};
+
+#endif // MAPPED_FILE_H
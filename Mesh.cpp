@@ -0,0 +1,63 @@
+#include "Mesh.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+indexed_mesh build_indexed_mesh(const float* vertices, const size_t vertex_count, const size_t floats_per_vertex)
+{
+    indexed_mesh mesh;
+    mesh.floats_per_vertex = floats_per_vertex;
+    mesh.indices.reserve(vertex_count);
+
+    const size_t vertex_size = floats_per_vertex * sizeof(float);
+
+    // key on the raw bytes of each vertex so only exact duplicates are welded (and -0.f stays distinct from 0.f, like the GPU sees it)
+    std::unordered_map<std::string, uint16_t> unique_vertices;
+    unique_vertices.reserve(vertex_count);
+
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        const float* vertex = vertices + i * floats_per_vertex;
+        std::string key(reinterpret_cast<const char*>(vertex), vertex_size);
+
+        auto found = unique_vertices.find(key);
+
+        if (found != unique_vertices.end())
+        {
+            mesh.indices.push_back(found->second);
+            continue;
+        }
+
+        const size_t new_index = mesh.vertex_count();
+
+        if (new_index > std::numeric_limits<uint16_t>::max())
+        {
+            std::cout << "ERROR::MESH::TOO_MANY_VERTICES_FOR_16_BIT_INDICES" << '\n';
+            return indexed_mesh{};
+        }
+
+        unique_vertices.emplace(std::move(key), static_cast<uint16_t>(new_index));
+        mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floats_per_vertex);
+        mesh.indices.push_back(static_cast<uint16_t>(new_index));
+    }
+
+    return mesh;
+}
+
+float bounding_sphere_radius(const indexed_mesh& mesh)
+{
+    float max_squared_distance = 0.f;
+
+    for (size_t i = 0; i + 2 < mesh.vertices.size(); i += mesh.floats_per_vertex)
+    {
+        const float x = mesh.vertices[i], y = mesh.vertices[i + 1], z = mesh.vertices[i + 2];
+        const float squared_distance = x * x + y * y + z * z;
+
+        if (squared_distance > max_squared_distance) max_squared_distance = squared_distance;
+    }
+
+    return std::sqrt(max_squared_distance);
+}
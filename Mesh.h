@@ -0,0 +1,26 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A mesh whose duplicate vertices have been welded together; every triangle corner references a unique vertex through indices
+struct indexed_mesh
+{
+    std::vector<float> vertices;
+    std::vector<uint16_t> indices;
+    size_t floats_per_vertex = 0;
+
+    size_t vertex_count() const { return floats_per_vertex ? vertices.size() / floats_per_vertex : 0; }
+};
+
+// Welds bit-identical vertices of an expanded triangle list (e.g. position + uv interleaved) into a unique vertex set plus a
+// 16-bit index buffer. Returns an empty mesh if the unique vertex count doesn't fit in 16-bit indices.
+indexed_mesh build_indexed_mesh(const float* vertices, size_t vertex_count, size_t floats_per_vertex);
+
+// Radius of the smallest origin-centred sphere containing every vertex position (the first three floats of each vertex).
+// It doesn't change under rotation, which makes it a cheap culling bound for spinning instances.
+float bounding_sphere_radius(const indexed_mesh& mesh);
+
+#endif // MESH_H
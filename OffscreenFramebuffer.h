@@ -0,0 +1,74 @@
+#ifndef OFFSCREEN_FRAMEBUFFER_H
+#define OFFSCREEN_FRAMEBUFFER_H
+
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+
+// A framebuffer object with an RGBA8 color and a depth renderbuffer (24-bit unless asked otherwise, e.g. float depth for
+// reverse-Z), used as the render target when there is no window
+class OffscreenFramebuffer
+{
+public:
+    GLuint id;
+    GLuint color_renderbuffer;
+    GLuint depth_renderbuffer;
+    int width;
+    int height;
+
+    OffscreenFramebuffer(const int width, const int height, const GLenum depth_format = GL_DEPTH_COMPONENT24) : width(width), height(height)
+    {
+        glGenFramebuffers(1, &id);
+        glGenRenderbuffers(1, &color_renderbuffer);
+        glGenRenderbuffers(1, &depth_renderbuffer);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        
+        glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, depth_format, width, height);
+        
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_renderbuffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE" << '\n';
+        }
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    ~OffscreenFramebuffer()
+    {
+        glDeleteFramebuffers(1, &id);
+        glDeleteRenderbuffers(1, &color_renderbuffer);
+        glDeleteRenderbuffers(1, &depth_renderbuffer);
+    }
+
+    OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+    OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+
+    void bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, id);
+    }
+
+    // reads the color attachment back as tightly packed RGB rows, bottom row first (GL's origin)
+    std::vector<unsigned char> read_pixels() const
+    {
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+        return pixels;
+    }
+};
+
+#endif // OFFSCREEN_FRAMEBUFFER_H
@@ -0,0 +1,96 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+// Fixed-step simulation time kept in integer nanoseconds, so the step length stays exact however long the program runs.
+// Each frame adds the real time that passed to an accumulator, and step() hands out whole steps from it until less than one
+// is left; that remainder, as a fraction of a step, is how far rendering should interpolate from the previous simulated
+// state to the current one. At most max_steps_per_frame steps are handed out per frame, so a long stall (a breakpoint,
+// a dragged window) slows the simulation down instead of making every later frame try to catch up.
+class SimulationClock
+{
+public:
+    explicit SimulationClock(const int64_t step_nanoseconds = default_step_nanoseconds, const unsigned int max_steps_per_frame = 8)
+        : step_nanoseconds(step_nanoseconds), max_accumulated_nanoseconds(step_nanoseconds * max_steps_per_frame)
+    {
+    }
+
+    // monotonic time in nanoseconds, unaffected by changes to the wall clock
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // adds the real time since the previous call; the first call only starts the clock
+    void advance_to(const int64_t now_nanoseconds)
+    {
+        if (started) advance(now_nanoseconds - last_advance_nanoseconds);
+
+        last_advance_nanoseconds = now_nanoseconds;
+        started = true;
+    }
+
+    // adds an explicit amount of time, e.g. exactly one step per frame for runs that must be reproducible
+    void advance(const int64_t elapsed_nanoseconds)
+    {
+        accumulated_nanoseconds += elapsed_nanoseconds > 0 ? elapsed_nanoseconds : 0;
+
+        if (accumulated_nanoseconds > max_accumulated_nanoseconds) accumulated_nanoseconds = max_accumulated_nanoseconds;
+    }
+
+    // consumes one step if a whole one has accumulated; call until it returns false, simulating one step each time
+    bool step()
+    {
+        if (accumulated_nanoseconds < step_nanoseconds) return false;
+
+        accumulated_nanoseconds -= step_nanoseconds;
+        tick++;
+
+        return true;
+    }
+
+    // steps simulated so far
+    uint64_t get_tick() const
+    {
+        return tick;
+    }
+
+    int64_t get_step_nanoseconds() const
+    {
+        return step_nanoseconds;
+    }
+
+    float get_step_seconds() const
+    {
+        return static_cast<float>(static_cast<double>(step_nanoseconds) * 1e-9);
+    }
+
+    // how far from the previous step's state to the current one rendering is, in [0, 1)
+    float get_interpolation_alpha() const
+    {
+        return static_cast<float>(static_cast<double>(accumulated_nanoseconds) / static_cast<double>(step_nanoseconds));
+    }
+
+    // simulation time that the interpolated state corresponds to: the previous step plus the alpha fraction, which trails
+    // real time by up to one step. Kept exact, so periodic animations can reduce it modulo their period before it's narrowed.
+    int64_t get_render_time_nanoseconds() const
+    {
+        if (tick == 0) return 0;
+
+        return static_cast<int64_t>(tick - 1) * step_nanoseconds + accumulated_nanoseconds;
+    }
+
+    static constexpr int64_t default_step_nanoseconds = 1000000000 / 60;
+
+private:
+    int64_t step_nanoseconds;
+    int64_t max_accumulated_nanoseconds;
+    int64_t accumulated_nanoseconds = 0;
+    int64_t last_advance_nanoseconds = 0;
+    uint64_t tick = 0;
+    bool started = false;
+};
+
+#endif // SIMULATION_CLOCK_H
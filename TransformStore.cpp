@@ -0,0 +1,158 @@
+#include "TransformStore.h"
+
+#include "simd_math.h"
+
+namespace
+{
+    // rotation columns 0-2 plus the translation column for `lanes` instances, one register per matrix element
+    template <typename V>
+    struct model_matrix_lanes
+    {
+        V m00, m01, m02;
+        V m10, m11, m12;
+        V m20, m21, m22;
+        V tx, ty, tz;
+    };
+
+    void store_model_matrices(const model_matrix_lanes<f32x1>& m, glm::mat4* out)
+    {
+        glm::mat4& model = out[0];
+        model[0] = glm::vec4(m.m00.v, m.m01.v, m.m02.v, 0.f);
+        model[1] = glm::vec4(m.m10.v, m.m11.v, m.m12.v, 0.f);
+        model[2] = glm::vec4(m.m20.v, m.m21.v, m.m22.v, 0.f);
+        model[3] = glm::vec4(m.tx.v, m.ty.v, m.tz.v, 1.f);
+    }
+
+#ifdef SIMD_MATH_SSE2
+    // one 4x4 transpose per matrix column turns "element k of instances 0-3" into "column of instance i".
+    // Plain stores: the same frame reads the matrices straight back for culling and drawing, so they should stay in cache.
+    void store_column(__m128 x, __m128 y, __m128 z, __m128 w, float* out, const size_t column)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        float* first = out + column * 4;
+
+        _mm_storeu_ps(first + 0 * 16, x);
+        _mm_storeu_ps(first + 1 * 16, y);
+        _mm_storeu_ps(first + 2 * 16, z);
+        _mm_storeu_ps(first + 3 * 16, w);
+    }
+    
+    void store_model_matrices(const model_matrix_lanes<f32x4>& m, glm::mat4* out)
+    {
+        float* base = &out[0][0][0];
+        const __m128 zero = _mm_setzero_ps();
+
+        store_column(m.m00.v, m.m01.v, m.m02.v, zero, base, 0);
+        store_column(m.m10.v, m.m11.v, m.m12.v, zero, base, 1);
+        store_column(m.m20.v, m.m21.v, m.m22.v, zero, base, 2);
+        store_column(m.tx.v, m.ty.v, m.tz.v, _mm_set1_ps(1.f), base, 3);
+    }
+#endif
+
+#ifdef SIMD_MATH_AVX2
+    f32x4 low_half(const f32x8 x) { return {_mm256_castps256_ps128(x.v)}; }
+    f32x4 high_half(const f32x8 x) { return {_mm256_extractf128_ps(x.v, 1)}; }
+
+    void store_model_matrices(const model_matrix_lanes<f32x8>& m, glm::mat4* out)
+    {
+        store_model_matrices(model_matrix_lanes<f32x4>{
+            low_half(m.m00), low_half(m.m01), low_half(m.m02),
+            low_half(m.m10), low_half(m.m11), low_half(m.m12),
+            low_half(m.m20), low_half(m.m21), low_half(m.m22),
+            low_half(m.tx), low_half(m.ty), low_half(m.tz)}, out);
+        
+        store_model_matrices(model_matrix_lanes<f32x4>{
+            high_half(m.m00), high_half(m.m01), high_half(m.m02),
+            high_half(m.m10), high_half(m.m11), high_half(m.m12),
+            high_half(m.m20), high_half(m.m21), high_half(m.m22),
+            high_half(m.tx), high_half(m.ty), high_half(m.tz)}, out + 4);
+    }
+#endif
+}
+
+size_t TransformStore::add(const glm::vec3& position, const glm::vec3& axis, const float angle, const float angular_velocity)
+{
+    const glm::vec3 unit_axis = glm::normalize(axis);
+
+    position_x.push_back(position.x);
+    position_y.push_back(position.y);
+    position_z.push_back(position.z);
+    axis_x.push_back(unit_axis.x);
+    axis_y.push_back(unit_axis.y);
+    axis_z.push_back(unit_axis.z);
+    this->angle.push_back(angle);
+    this->angular_velocity.push_back(angular_velocity);
+
+    return size() - 1;
+}
+
+void TransformStore::reserve(const size_t count)
+{
+    for (std::vector<float>* values : {&position_x, &position_y, &position_z, &axis_x, &axis_y, &axis_z, &angle, &angular_velocity})
+    {
+        values->reserve(count);
+    }
+}
+
+// Builds V::lanes matrices starting at begin, the same way glm::rotate does (Rodrigues' formula), with the translation
+// written straight into the last column instead of multiplying by a translation matrix. Returns the next instance index.
+template <typename V>
+size_t TransformStore::compute_batch(const size_t begin, const float time, glm::mat4* out) const
+{
+    const V x = V::load(axis_x.data() + begin);
+    const V y = V::load(axis_y.data() + begin);
+    const V z = V::load(axis_z.data() + begin);
+    
+    const V theta = V::load(angle.data() + begin) + V::load(angular_velocity.data() + begin) * V::broadcast(time);
+
+    V s, c;
+    sincos(theta, s, c);
+
+    const V one_minus_c = V::broadcast(1.f) - c;
+    const V tx = one_minus_c * x;
+    const V ty = one_minus_c * y;
+    const V tz = one_minus_c * z;
+
+    const model_matrix_lanes<V> m{
+        c + tx * x, tx * y + s * z, tx * z - s * y,
+        ty * x - s * z, c + ty * y, ty * z + s * x,
+        tz * x + s * y, tz * y - s * x, c + tz * z,
+        V::load(position_x.data() + begin), V::load(position_y.data() + begin), V::load(position_z.data() + begin)
+    };
+
+    store_model_matrices(m, out + begin);
+
+    return begin + V::lanes;
+}
+
+void TransformStore::compute_model_matrices(const float time, glm::mat4* out) const
+{
+    const size_t count = size();
+    size_t i = 0;
+
+    while (i + f32xn::lanes <= count)
+    {
+        i = compute_batch<f32xn>(i, time, out);
+    }
+
+#if defined(SIMD_MATH_AVX2)
+    // an AVX2 build still has SSE2, so a leftover group of 4 doesn't have to go through the scalar kernel
+    if (i + f32x4::lanes <= count)
+    {
+        i = compute_batch<f32x4>(i, time, out);
+    }
+#endif
+
+    while (i < count)
+    {
+        i = compute_batch<f32x1>(i, time, out);
+    }
+}
+
+void TransformStore::compute_model_matrices_scalar(const float time, glm::mat4* out) const
+{
+    for (size_t i = 0; i < size(); i = compute_batch<f32x1>(i, time, out))
+    {
+    }
+}
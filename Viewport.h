@@ -0,0 +1,169 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include <cmath>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Frustum.h"
+#include "gl_extensions.h"
+
+#ifndef GL_ZERO_TO_ONE
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+
+enum class depth_mode : uint8_t
+{
+    // glm::perspective: [-1, 1] clip depth, cleared to 1, closer fragments have smaller depth
+    standard,
+    
+    // near plane at depth 1, infinitely far at 0, with [0, 1] clip depth. With a float depth buffer the float exponent cancels
+    // the 1/z falloff, so precision stays even out to any distance and there is no far plane to clip against
+    reverse_z_infinite
+};
+
+// Framebuffer size and projection parameters. Resizes and zoom changes only record the new values (the resize callback makes
+// no GL calls); apply() pushes them once per frame, and the projection is rebuilt only if one of them actually changed.
+class Viewport
+{
+public:
+    Viewport(const int width, const int height, const float near_plane = 0.1f, const float far_plane = 100.f)
+        : width(width), height(height), near_plane(near_plane), far_plane(far_plane)
+    {
+    }
+
+    // a minimized window reports a 0x0 framebuffer; the last real size is kept so the aspect ratio stays finite
+    void resize(const int new_width, const int new_height)
+    {
+        if (new_width <= 0 || new_height <= 0 || (new_width == width && new_height == height)) return;
+
+        width = new_width;
+        height = new_height;
+        size_dirty = true;
+        projection_dirty = true;
+    }
+
+    // vertical field of view in degrees
+    void set_field_of_view(const float degrees)
+    {
+        if (degrees == field_of_view) return;
+
+        field_of_view = degrees;
+        projection_dirty = true;
+    }
+
+    // the far plane is ignored by reverse_z_infinite
+    void set_clip_planes(const float near, const float far)
+    {
+        if (near == near_plane && far == far_plane) return;
+
+        near_plane = near;
+        far_plane = far;
+        projection_dirty = true;
+    }
+
+    // GL thread. Needs glClipControl (GL 4.5 or ARB_clip_control) for the [0, 1] depth range; returns false and keeps the
+    // standard mode without it. Also flips the depth test and clear value, so it's meant to be called once at startup.
+    bool enable_reverse_z()
+    {
+        using clip_control_function = void (APIENTRY*)(GLenum origin, GLenum depth);
+
+        if (!has_gl_extension("GL_ARB_clip_control")) return false;
+
+        const auto clip_control = load_gl_function<clip_control_function>("glClipControl");
+
+        if (!clip_control) return false;
+
+        clip_control(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        glDepthFunc(GL_GREATER);
+        glClearDepth(0.0);
+
+        mode = depth_mode::reverse_z_infinite;
+        projection_dirty = true;
+
+        return true;
+    }
+
+    // GL thread, once per frame. Returns true if the projection matrix was rebuilt since the last call.
+    bool apply()
+    {
+        if (size_dirty)
+        {
+            glViewport(0, 0, width, height);
+            size_dirty = false;
+        }
+
+        if (!projection_dirty) return false;
+
+        const float aspect_ratio = get_aspect_ratio();
+
+        if (mode == depth_mode::reverse_z_infinite)
+        {
+            // the limit of a reversed [0, 1] perspective as far goes to infinity: clip z is the constant near plane distance,
+            // so depth = near / distance
+            const float focal_length = 1.f / std::tan(glm::radians(field_of_view) * 0.5f);
+
+            projection_matrix = glm::mat4(0.f);
+            projection_matrix[0][0] = focal_length / aspect_ratio;
+            projection_matrix[1][1] = focal_length;
+            projection_matrix[2][3] = -1.f;
+            projection_matrix[3][2] = near_plane;
+        }
+        else
+        {
+            projection_matrix = glm::perspective(glm::radians(field_of_view), aspect_ratio, near_plane, far_plane);
+        }
+
+        projection_dirty = false;
+
+        return true;
+    }
+
+    const glm::mat4& get_projection_matrix() const
+    {
+        return projection_matrix;
+    }
+
+    // what extract_frustum() needs to know about the projection
+    clip_depth_range get_clip_depth_range() const
+    {
+        return mode == depth_mode::reverse_z_infinite ? clip_depth_range::zero_to_one : clip_depth_range::negative_one_to_one;
+    }
+
+    depth_mode get_depth_mode() const
+    {
+        return mode;
+    }
+
+    float get_aspect_ratio() const
+    {
+        return static_cast<float>(width) / static_cast<float>(height);
+    }
+
+    int get_width() const
+    {
+        return width;
+    }
+
+    int get_height() const
+    {
+        return height;
+    }
+
+private:
+    int width;
+    int height;
+    float field_of_view = 45.f;
+    float near_plane;
+    float far_plane;
+    depth_mode mode = depth_mode::standard;
+
+    bool size_dirty = true;
+    bool projection_dirty = true;
+    glm::mat4 projection_matrix{1.f};
+};
+
+#endif // VIEWPORT_H
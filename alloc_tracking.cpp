@@ -0,0 +1,89 @@
+#include "alloc_tracking.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifndef NDEBUG
+
+namespace
+{
+    thread_local size_t allocation_count = 0;
+}
+
+// replacing the plain and the aligned throwing new/delete is enough: the array and nothrow forms forward to these by default.
+// The sized deletes are replaced too, so they free with the matching function.
+void* operator new(const size_t size)
+{
+    allocation_count++;
+
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+    allocation_count++;
+
+    const auto alignment_bytes = static_cast<size_t>(alignment);
+    const size_t bytes = size ? size : 1;
+
+#ifdef _WIN32
+    void* memory = _aligned_malloc(bytes, alignment_bytes);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    void* memory = std::aligned_alloc(alignment_bytes, (bytes + alignment_bytes - 1) / alignment_bytes * alignment_bytes);
+#endif
+
+    if (memory)
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, size_t, const std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+size_t heap_allocation_count()
+{
+    return allocation_count;
+}
+
+#else
+
+size_t heap_allocation_count()
+{
+    return 0;
+}
+
+#endif
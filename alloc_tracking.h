@@ -0,0 +1,10 @@
+#ifndef ALLOC_TRACKING_H
+#define ALLOC_TRACKING_H
+
+#include <cstddef>
+
+// Number of global operator new calls made so far by the calling thread, so background workers don't show up in the
+// render loop's count. Only counted in debug builds (NDEBUG not defined); always 0 otherwise.
+size_t heap_allocation_count();
+
+#endif // ALLOC_TRACKING_H
@@ -0,0 +1,416 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#include "Camera.h"
+#include "Frustum.h"
+#include "mat4_math.h"
+#include "stb_image.h"
+#include "utils.h"
+#include "textures/BlockCompression.h"
+#include "textures/MipChain.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+    // frames spent on each leg of the route; the route repeats after four legs
+    constexpr unsigned int path_leg_frames = 120;
+
+    double percentile(const std::vector<double>& sorted_values, const double fraction)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted_values.size())));
+        
+        return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+    }
+
+    // Baseline for run_mip_benchmark: averages encoded bytes directly, one texel and channel at a time
+    std::vector<mip_level> build_mip_levels_per_pixel(const unsigned char* pixels, int width, int height, const int channels)
+    {
+        std::vector<mip_level> levels;
+        const unsigned char* source = pixels;
+
+        while (width > 1 || height > 1)
+        {
+            mip_level level{{}, std::max(width / 2, 1), std::max(height / 2, 1)};
+            level.pixels.resize(static_cast<size_t>(level.width) * level.height * channels);
+
+            for (int y = 0; y < level.height; y++)
+            {
+                const int y0 = std::min(y * 2, height - 1);
+                const int y1 = std::min(y * 2 + 1, height - 1);
+
+                for (int x = 0; x < level.width; x++)
+                {
+                    const int x0 = std::min(x * 2, width - 1);
+                    const int x1 = std::min(x * 2 + 1, width - 1);
+
+                    for (int c = 0; c < channels; c++)
+                    {
+                        const unsigned int sum = source[(static_cast<size_t>(y0) * width + x0) * channels + c]
+                            + source[(static_cast<size_t>(y0) * width + x1) * channels + c]
+                            + source[(static_cast<size_t>(y1) * width + x0) * channels + c]
+                            + source[(static_cast<size_t>(y1) * width + x1) * channels + c];
+
+                        level.pixels[(static_cast<size_t>(y) * level.width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+
+            levels.push_back(std::move(level));
+            source = levels.back().pixels.data();
+            width = levels.back().width;
+            height = levels.back().height;
+        }
+
+        return levels;
+    }
+
+    // over the first `compared_channels` channels starting at `first_channel`; the decoded image is always RGBA
+    double peak_signal_to_noise(const unsigned char* source, const int source_channels, const unsigned char* decoded, const size_t texel_count,
+                                const int first_channel, const int compared_channels)
+    {
+        double squared_error = 0.0;
+
+        for (size_t i = 0; i < texel_count; i++)
+        {
+            for (int c = first_channel; c < first_channel + compared_channels; c++)
+            {
+                const double delta = static_cast<double>(source[i * source_channels + c]) - decoded[i * 4 + c];
+                squared_error += delta * delta;
+            }
+        }
+
+        const double mean_squared_error = squared_error / (static_cast<double>(texel_count) * compared_channels);
+
+        return mean_squared_error > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mean_squared_error) : INFINITY;
+    }
+}
+
+void apply_benchmark_camera_path(Camera& camera, const unsigned int step_index, const float delta_time)
+{
+    // walk into the field, turn around, walk back out and turn again, sweeping the view over every cube
+    switch ((step_index / path_leg_frames) % 4)
+    {
+    case 0:
+        camera.process_keyboard(FORWARD, delta_time);
+        camera.process_mouse_movement(1.f, 0.f);
+        break;
+    case 1:
+        camera.process_keyboard(LEFT, delta_time);
+        camera.process_mouse_movement(-3.f, 0.5f);
+        break;
+    case 2:
+        camera.process_keyboard(BACKWARD, delta_time);
+        camera.process_mouse_movement(-1.f, 0.f);
+        break;
+    default:
+        camera.process_keyboard(RIGHT, delta_time);
+        camera.process_mouse_movement(3.f, -0.5f);
+        break;
+    }
+}
+
+frame_time_stats compute_frame_time_stats(std::vector<double>& frame_times_ms)
+{
+    frame_time_stats stats;
+
+    if (frame_times_ms.empty()) return stats;
+
+    std::sort(frame_times_ms.begin(), frame_times_ms.end());
+
+    const double total_ms = std::accumulate(frame_times_ms.begin(), frame_times_ms.end(), 0.0);
+
+    stats.frame_count = static_cast<unsigned int>(frame_times_ms.size());
+    stats.min_ms = frame_times_ms.front();
+    stats.median_ms = percentile(frame_times_ms, 0.5);
+    stats.p95_ms = percentile(frame_times_ms, 0.95);
+    stats.p99_ms = percentile(frame_times_ms, 0.99);
+    stats.max_ms = frame_times_ms.back();
+    stats.mean_ms = total_ms / static_cast<double>(frame_times_ms.size());
+    stats.frames_per_second = total_ms > 0.0 ? 1000.0 * static_cast<double>(frame_times_ms.size()) / total_ms : 0.0;
+
+    return stats;
+}
+
+void print_frame_time_stats(const frame_time_stats& stats)
+{
+    std::cout << "frames: " << stats.frame_count
+        << " | min " << stats.min_ms << " ms"
+        << " | median " << stats.median_ms << " ms"
+        << " | p95 " << stats.p95_ms << " ms"
+        << " | p99 " << stats.p99_ms << " ms"
+        << " | max " << stats.max_ms << " ms"
+        << " | " << stats.frames_per_second << " fps" << '\n';
+}
+
+bool write_frame_time_stats_json(const std::string& filename, const frame_time_stats& stats, const benchmark_configuration& configuration, const culling_stats& cube_culling)
+{
+    std::ofstream file(filename);
+
+    if (!file.is_open()) return false;
+
+    file << "{\n"
+        << "  \"render_mode\": \"" << configuration.render_mode << "\",\n"
+        << "  \"uniform_path\": \"" << configuration.uniform_path << "\",\n"
+        << "  \"frame_count\": " << stats.frame_count << ",\n"
+        << "  \"cpu_frame_time_ms\": {\n"
+        << "    \"min\": " << stats.min_ms << ",\n"
+        << "    \"median\": " << stats.median_ms << ",\n"
+        << "    \"p95\": " << stats.p95_ms << ",\n"
+        << "    \"p99\": " << stats.p99_ms << ",\n"
+        << "    \"max\": " << stats.max_ms << ",\n"
+        << "    \"mean\": " << stats.mean_ms << "\n"
+        << "  },\n"
+        << "  \"frames_per_second\": " << stats.frames_per_second << ",\n"
+        << "  \"cubes_submitted\": " << cube_culling.submitted << ",\n"
+        << "  \"cubes_culled\": " << cube_culling.culled << "\n"
+        << "}\n";
+
+    return file.good();
+}
+
+bool run_mip_benchmark(const std::string& image_path, const unsigned int repeats)
+{
+    int width, height, channels;
+    unsigned char* pixels = load_image(image_path, width, height, channels);
+
+    if (!pixels)
+    {
+        std::cout << "ERROR::BENCHMARK::IMAGE_NOT_LOADED: " << image_path << '\n';
+        return false;
+    }
+
+    mip_options box;
+    mip_options kaiser;
+    kaiser.filter = mip_filter::kaiser;
+
+    const struct
+    {
+        const char* name;
+        std::vector<mip_level> (*build)(const unsigned char*, int, int, int, const mip_options&);
+        const mip_options* options;
+    } variants[] = {
+        {"per-pixel 8-bit box", [](const unsigned char* p, int w, int h, int c, const mip_options&) { return build_mip_levels_per_pixel(p, w, h, c); }, &box},
+        {"scalar box", build_mip_levels_scalar, &box},
+        {"simd box", build_mip_levels, &box},
+        {"scalar kaiser", build_mip_levels_scalar, &kaiser},
+        {"simd kaiser", build_mip_levels, &kaiser},
+    };
+
+    std::cout << image_path << ": " << width << "x" << height << ", " << channels << " channels, median of " << repeats << " runs" << '\n';
+
+    std::vector<double> times_ms;
+
+    for (const auto& variant : variants)
+    {
+        times_ms.clear();
+
+        for (unsigned int i = 0; i < std::max(repeats, 1u); i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const std::vector<mip_level> levels = variant.build(pixels, width, height, channels, *variant.options);
+            times_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        const frame_time_stats stats = compute_frame_time_stats(times_ms);
+        const double source_megabytes = static_cast<double>(width) * height * channels / (1024.0 * 1024.0);
+
+        std::cout << "  " << variant.name << ": " << stats.median_ms << " ms (" << source_megabytes * 1000.0 / stats.median_ms << " MB/s)" << '\n';
+    }
+
+    stbi_image_free(pixels);
+
+    return true;
+}
+
+bool run_compression_benchmark(const std::string& image_path, const unsigned int repeats)
+{
+    int width, height, channels;
+    unsigned char* pixels = load_image(image_path, width, height, channels);
+
+    if (!pixels || channels < 3)
+    {
+        std::cout << "ERROR::BENCHMARK::IMAGE_NOT_LOADED: " << image_path << " (needs an RGB or RGBA image)" << '\n';
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    const struct
+    {
+        const char* name;
+        block_format format;
+    } formats[] = {{"bc1", block_format::bc1}, {"bc3", block_format::bc3}, {"bc7", block_format::bc7}};
+
+    const size_t texel_count = static_cast<size_t>(width) * height;
+    const double megapixels = static_cast<double>(texel_count) / 1e6;
+    const unsigned int hardware_threads = std::thread::hardware_concurrency();
+    std::vector<unsigned int> thread_counts = {1};
+
+    if (hardware_threads > 1) thread_counts.push_back(hardware_threads);
+
+    std::cout << image_path << ": " << width << "x" << height << ", " << channels << " channels, median of " << repeats << " runs" << '\n';
+
+    std::vector<double> times_ms;
+    std::vector<unsigned char> decoded(texel_count * 4);
+
+    for (const auto& format : formats)
+    {
+        std::vector<unsigned char> blocks;
+
+        std::cout << "  " << format.name << ":";
+
+        for (const unsigned int thread_count : thread_counts)
+        {
+            times_ms.clear();
+
+            for (unsigned int i = 0; i < std::max(repeats, 1u); i++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                blocks = compress_image(pixels, width, height, channels, format.format, thread_count);
+                times_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            const double median_ms = compute_frame_time_stats(times_ms).median_ms;
+
+            std::cout << " " << median_ms << " ms on " << thread_count << (thread_count == 1 ? " thread" : " threads")
+                << " (" << megapixels * 1000.0 / median_ms << " Mpx/s) |";
+        }
+
+        decompress_image(blocks.data(), width, height, format.format, decoded.data());
+
+        std::cout << " PSNR rgb " << peak_signal_to_noise(pixels, channels, decoded.data(), texel_count, 0, 3) << " dB";
+
+        if (channels == 4) std::cout << ", alpha " << peak_signal_to_noise(pixels, channels, decoded.data(), texel_count, 3, 1) << " dB";
+
+        std::cout << '\n';
+    }
+
+    stbi_image_free(pixels);
+
+    return true;
+}
+
+bool run_math_benchmark(const unsigned int repeats)
+{
+    constexpr size_t matrix_count = 4096;
+
+    // fixed seed, so every run checks and times the same matrices
+    std::mt19937 random(20240601);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    const auto random_vector = [&](const float scale)
+    {
+        return glm::vec3(unit(random), unit(random), unit(random)) * scale;
+    };
+
+    struct matrix_set
+    {
+        std::vector<glm::mat4> rigid;   // rotation + translation
+        std::vector<glm::mat4> general; // any values
+        glm::mat4 view_projection;
+    } inputs;
+
+    for (size_t i = 0; i < matrix_count; i++)
+    {
+        const glm::mat4 translation = glm::translate(glm::mat4(1.f), random_vector(50.f));
+        const glm::vec3 axis = random_vector(1.f) + glm::vec3(0.f, 0.f, 1e-3f);
+
+        inputs.rigid.push_back(glm::rotate(translation, unit(random) * 3.14159265f, glm::normalize(axis)));
+
+        glm::mat4 general;
+        for (int column = 0; column < 4; column++) general[column] = glm::vec4(random_vector(10.f), unit(random) * 10.f);
+
+        inputs.general.push_back(general);
+    }
+
+    inputs.view_projection = glm::perspective(glm::radians(45.f), 800.f / 600.f, 0.1f, 100.f) * glm::lookAt(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+
+    using kernel_function = void (*)(const matrix_set& in, glm::mat4* out);
+
+    const struct
+    {
+        const char* name;
+        kernel_function reference;
+        kernel_function kernel;
+        float tolerance; // relative to the magnitude of each element, at least 1
+    } kernels[] = {
+        {"multiply",
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = in.general[i] * in.rigid[i]; },
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = mat4_multiply(in.general[i], in.rigid[i]); },
+            0.f},
+        {"affine multiply",
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = in.rigid[i] * in.rigid[matrix_count - 1 - i]; },
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = mat4_multiply_affine(in.rigid[i], in.rigid[matrix_count - 1 - i]); },
+            1e-6f},
+        {"batched multiply",
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = in.view_projection * in.rigid[i]; },
+            [](const matrix_set& in, glm::mat4* out) { mat4_multiply_batch(in.view_projection, in.rigid.data(), out, matrix_count); },
+            0.f},
+        {"rigid inverse",
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = glm::inverse(in.rigid[i]); },
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = mat4_inverse_rigid(in.rigid[i]); },
+            1e-4f}, // glm::inverse expands cofactors, which is itself only good to about 1e-5 here
+        {"look-at",
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = glm::lookAt(glm::vec3(in.rigid[i][3]), glm::vec3(in.rigid[i][3] - in.rigid[i][2]), glm::vec3(0.f, 1.f, 0.f)); },
+            [](const matrix_set& in, glm::mat4* out) { for (size_t i = 0; i < matrix_count; i++) out[i] = mat4_look_at(glm::vec3(in.rigid[i][3]), glm::vec3(in.rigid[i][3] - in.rigid[i][2]), glm::vec3(0.f, 1.f, 0.f)); },
+            1e-6f},
+    };
+
+    std::cout << matrix_count << " matrices per run, median of " << repeats << " runs" << '\n';
+
+    std::vector<glm::mat4> expected(matrix_count);
+    std::vector<glm::mat4> actual(matrix_count);
+    std::vector<double> times_ms;
+
+    const auto time_kernel = [&](const kernel_function function, glm::mat4* out)
+    {
+        times_ms.clear();
+
+        for (unsigned int i = 0; i < std::max(repeats, 1u); i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function(inputs, out);
+            times_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        return compute_frame_time_stats(times_ms).median_ms * 1e6 / matrix_count;
+    };
+
+    bool all_match = true;
+
+    for (const auto& kernel : kernels)
+    {
+        const double reference_ns = time_kernel(kernel.reference, expected.data());
+        const double kernel_ns = time_kernel(kernel.kernel, actual.data());
+
+        float max_error = 0.f;
+
+        for (size_t i = 0; i < matrix_count; i++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 4; row++)
+                {
+                    const float reference = expected[i][column][row];
+                    max_error = std::max(max_error, std::abs(actual[i][column][row] - reference) / std::max(1.f, std::abs(reference)));
+                }
+            }
+        }
+
+        const bool matches = max_error <= kernel.tolerance;
+        all_match = all_match && matches;
+
+        std::cout << "  " << kernel.name << ": glm " << reference_ns << " ns, mat4_math " << kernel_ns << " ns per matrix ("
+            << reference_ns / kernel_ns << "x) | max relative error " << max_error << (matches ? "" : " EXCEEDS TOLERANCE") << '\n';
+    }
+
+    return all_match;
+}
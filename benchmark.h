@@ -0,0 +1,54 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+class Camera;
+struct culling_stats;
+
+struct frame_time_stats
+{
+    unsigned int frame_count = 0;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    double mean_ms = 0.0;
+    double frames_per_second = 0.0;
+};
+
+// the settings a benchmark run was made with, recorded next to its timings so runs of different configurations can be compared
+struct benchmark_configuration
+{
+    std::string render_mode;
+    std::string uniform_path;
+};
+
+// Moves the camera along a fixed, scripted route by feeding it the same keyboard/mouse events real input would, so a
+// benchmark run exercises the normal camera code and renders the exact same frames every time. Called once per fixed
+// simulation step.
+void apply_benchmark_camera_path(Camera& camera, unsigned int step_index, float delta_time);
+
+// Nearest-rank percentiles over the recorded CPU frame times. Sorts the given vector.
+frame_time_stats compute_frame_time_stats(std::vector<double>& frame_times_ms);
+
+void print_frame_time_stats(const frame_time_stats& stats);
+
+// cube_culling holds the cube totals over the whole run, warm-up frames included
+bool write_frame_time_stats_json(const std::string& filename, const frame_time_stats& stats, const benchmark_configuration& configuration, const culling_stats& cube_culling);
+
+// Times full mip chain builds for one image: a per-pixel 8-bit box loop (the gamma-naive way stb-style code does it) against
+// the scalar and SIMD instantiations of the float box and Kaiser kernels. Prints the median of `repeats` runs of each.
+bool run_mip_benchmark(const std::string& image_path, unsigned int repeats);
+
+// Encodes one image as BC1, BC3 and BC7 on one thread and on every hardware thread, printing the median encode time and
+// throughput of `repeats` runs plus the PSNR of the decoded result (colour, and alpha for RGBA images)
+bool run_compression_benchmark(const std::string& image_path, unsigned int repeats);
+
+// Checks every mat4_math kernel against the glm expression it replaces on a few thousand random matrices, then times both
+// (median of `repeats` runs each). Returns false if any kernel differs from glm by more than float rounding.
+bool run_math_benchmark(unsigned int repeats);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,31 @@
+#include "gl_extensions.h"
+
+namespace
+{
+    GLADloadproc function_loader = nullptr;
+}
+
+void set_gl_function_loader(const GLADloadproc loader)
+{
+    function_loader = loader;
+}
+
+GLADloadproc get_gl_function_loader()
+{
+    return function_loader;
+}
+
+bool has_gl_extension(const std::string_view name)
+{
+    GLint extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+    for (GLint i = 0; i < extension_count; i++)
+    {
+        const auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+
+        if (extension && name == extension) return true;
+    }
+
+    return false;
+}
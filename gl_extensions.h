@@ -0,0 +1,27 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <string_view>
+
+#include <glad/glad.h>
+
+// The context is created as GL 3.3 core, so entry points from later versions or optional extensions (buffer storage,
+// program binaries, parallel shader compile...) aren't loaded by glad. These helpers query and load them on demand.
+
+// must be called once with the same loader glad was initialized with, after the context is current
+void set_gl_function_loader(GLADloadproc loader);
+
+GLADloadproc get_gl_function_loader();
+
+bool has_gl_extension(std::string_view name);
+
+// returns nullptr when the driver doesn't expose the entry point
+template <typename Function>
+Function load_gl_function(const char* name)
+{
+    const GLADloadproc loader = get_gl_function_loader();
+    
+    return loader ? reinterpret_cast<Function>(loader(name)) : nullptr;
+}
+
+#endif // GL_EXTENSIONS_H
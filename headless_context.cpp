@@ -0,0 +1,123 @@
+#include "headless_context.h"
+
+#include <iostream>
+
+#ifndef _WIN32
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+
+    EGLDisplay get_surfaceless_display()
+    {
+        // prefer the surfaceless platform: it needs neither a display server nor a render node to exist
+        const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+        if (get_platform_display)
+        {
+            EGLDisplay surfaceless_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+            if (surfaceless_display != EGL_NO_DISPLAY) return surfaceless_display;
+        }
+
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+bool create_headless_context()
+{
+    display = get_surfaceless_display();
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        std::cout << "ERROR::HEADLESS::EGL_DISPLAY_UNAVAILABLE" << '\n';
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "ERROR::HEADLESS::DESKTOP_GL_API_UNAVAILABLE" << '\n';
+        eglTerminate(display);
+        return false;
+    }
+
+    // the surface type defaults to EGL_WINDOW_BIT, which surfaceless displays never offer
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint config_count = 0;
+    
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        std::cout << "ERROR::HEADLESS::NO_MATCHING_EGL_CONFIG" << '\n';
+        eglTerminate(display);
+        return false;
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+
+    // no surface at all (EGL_KHR_surfaceless_context): the default framebuffer doesn't exist and everything renders into FBOs
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED" << '\n';
+        destroy_headless_context();
+        return false;
+    }
+
+    return true;
+}
+
+void destroy_headless_context()
+{
+    if (display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
+
+void* headless_get_proc_address(const char* name)
+{
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+#else
+
+bool create_headless_context()
+{
+    std::cout << "ERROR::HEADLESS::NOT_SUPPORTED_ON_THIS_PLATFORM" << '\n';
+    return false;
+}
+
+void destroy_headless_context()
+{
+}
+
+void* headless_get_proc_address(const char* name)
+{
+    return nullptr;
+}
+
+#endif
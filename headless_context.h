@@ -0,0 +1,13 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+// Creates a GL 3.3 core context with no window and no surface through EGL (Mesa's surfaceless platform, which runs on
+// llvmpipe when there is no GPU) and makes it current. Rendering has to go into a framebuffer object.
+bool create_headless_context();
+
+void destroy_headless_context();
+
+// GL function loader for the headless context, to be handed to gladLoadGLLoader
+void* headless_get_proc_address(const char* name);
+
+#endif // HEADLESS_CONTEXT_H
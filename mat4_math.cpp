@@ -0,0 +1,61 @@
+#include "mat4_math.h"
+
+void mat4_multiply_batch(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, const size_t count)
+{
+#if defined(SIMD_MATH_AVX2)
+    // two output columns per register: left's columns are duplicated into both halves, and an in-lane shuffle of two loaded
+    // columns of right broadcasts element k of each column into its own half
+    const __m256 columns[4] = {
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&left[0][0])),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&left[1][0])),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&left[2][0])),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&left[3][0]))
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* source = &right[i][0][0];
+        float* destination = &out[i][0][0];
+
+        for (int half = 0; half < 2; half++)
+        {
+            const __m256 b = _mm256_loadu_ps(source + half * 8);
+
+            __m256 sum = _mm256_mul_ps(columns[0], _mm256_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(columns[1], _mm256_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(columns[2], _mm256_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(columns[3], _mm256_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+
+            _mm256_storeu_ps(destination + half * 8, sum);
+        }
+    }
+#elif defined(SIMD_MATH_SSE2)
+    using namespace mat4_math_detail;
+
+    // left's columns stay in registers for the whole batch
+    const __m128 columns[4] = {load_column(left, 0), load_column(left, 1), load_column(left, 2), load_column(left, 3)};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const __m128 b0 = load_column(right[i], 0);
+        const __m128 b1 = load_column(right[i], 1);
+        const __m128 b2 = load_column(right[i], 2);
+        const __m128 b3 = load_column(right[i], 3);
+
+        store_column(out[i], 0, combine(columns, b0));
+        store_column(out[i], 1, combine(columns, b1));
+        store_column(out[i], 2, combine(columns, b2));
+        store_column(out[i], 3, combine(columns, b3));
+    }
+#else
+    for (size_t i = 0; i < count; i++) out[i] = mat4_multiply(left, right[i]);
+#endif
+}
+
+glm::mat4 mat4_look_at(const glm::vec3& eye, const glm::vec3& target, const glm::vec3& up)
+{
+    const glm::vec3 front = glm::normalize(target - eye);
+    const glm::vec3 right = glm::normalize(glm::cross(front, up));
+
+    return mat4_view_from_basis(right, glm::cross(right, front), front, eye);
+}
@@ -0,0 +1,187 @@
+#ifndef MAT4_MATH_H
+#define MAT4_MATH_H
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "simd_math.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MAT4_MATH_NEON 1
+#endif
+
+// 4x4 matrix kernels for the camera, transform and culling paths, on glm's column-major mat4 so results drop straight into
+// existing code. Each has an SSE2 path (AVX for the batched multiply), the general multiply also a NEON path on AArch64,
+// and everything a scalar fallback. Products sum in glm's order, so they match glm bit for bit; the inverse and look-at
+// agree with glm to within float rounding. The single-matrix kernels are inline, since a call costs about as much as they do.
+
+namespace mat4_math_detail
+{
+#ifdef SIMD_MATH_SSE2
+    inline __m128 load_column(const glm::mat4& m, const int column)
+    {
+        return _mm_loadu_ps(&m[column][0]);
+    }
+
+    inline void store_column(glm::mat4& m, const int column, const __m128 value)
+    {
+        _mm_storeu_ps(&m[column][0], value);
+    }
+
+    template <int lane>
+    __m128 splat(const __m128 v)
+    {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane));
+    }
+
+    // the columns of a weighted by the elements of one column b, summed in glm's order
+    inline __m128 combine(const __m128 a[4], const __m128 b)
+    {
+        __m128 result = _mm_mul_ps(a[0], splat<0>(b));
+        result = _mm_add_ps(result, _mm_mul_ps(a[1], splat<1>(b)));
+        result = _mm_add_ps(result, _mm_mul_ps(a[2], splat<2>(b)));
+        
+        return _mm_add_ps(result, _mm_mul_ps(a[3], splat<3>(b)));
+    }
+
+    // same, for a b whose w is known to be 0
+    inline __m128 combine_xyz(const __m128 a[4], const __m128 b)
+    {
+        __m128 result = _mm_mul_ps(a[0], splat<0>(b));
+        result = _mm_add_ps(result, _mm_mul_ps(a[1], splat<1>(b)));
+        
+        return _mm_add_ps(result, _mm_mul_ps(a[2], splat<2>(b)));
+    }
+
+    // inverse of the rigid transform with rotation columns c0-c2 (w = 0) and translation t: transposing [c0 c1 c2 e3] gives
+    // the inverse rotation's columns, and the inverse translation is that rotation applied to -t
+    inline glm::mat4 inverse_rigid_columns(__m128 c0, __m128 c1, __m128 c2, const __m128 t)
+    {
+        __m128 e3 = _mm_set_ps(1.f, 0.f, 0.f, 0.f);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, e3);
+
+        const __m128 rotation[4] = {c0, c1, c2, e3};
+
+        glm::mat4 result;
+        store_column(result, 0, c0);
+        store_column(result, 1, c1);
+        store_column(result, 2, c2);
+        store_column(result, 3, _mm_sub_ps(_mm_set_ps(1.f, 0.f, 0.f, 0.f), combine_xyz(rotation, t)));
+
+        return result;
+    }
+#else
+    inline glm::mat4 inverse_rigid_columns(const glm::vec3& c0, const glm::vec3& c1, const glm::vec3& c2, const glm::vec3& t)
+    {
+        glm::mat4 result;
+        result[0] = glm::vec4(c0.x, c1.x, c2.x, 0.f);
+        result[1] = glm::vec4(c0.y, c1.y, c2.y, 0.f);
+        result[2] = glm::vec4(c0.z, c1.z, c2.z, 0.f);
+        result[3] = -(result[0] * t.x + result[1] * t.y + result[2] * t.z);
+        result[3].w = 1.f;
+
+        return result;
+    }
+#endif
+}
+
+// a * b
+inline glm::mat4 mat4_multiply(const glm::mat4& a, const glm::mat4& b)
+{
+    glm::mat4 result;
+
+#if defined(SIMD_MATH_SSE2)
+    using namespace mat4_math_detail;
+
+    const __m128 columns[4] = {load_column(a, 0), load_column(a, 1), load_column(a, 2), load_column(a, 3)};
+
+    store_column(result, 0, combine(columns, load_column(b, 0)));
+    store_column(result, 1, combine(columns, load_column(b, 1)));
+    store_column(result, 2, combine(columns, load_column(b, 2)));
+    store_column(result, 3, combine(columns, load_column(b, 3)));
+#elif defined(MAT4_MATH_NEON)
+    const float32x4_t a0 = vld1q_f32(&a[0][0]);
+    const float32x4_t a1 = vld1q_f32(&a[1][0]);
+    const float32x4_t a2 = vld1q_f32(&a[2][0]);
+    const float32x4_t a3 = vld1q_f32(&a[3][0]);
+
+    for (int i = 0; i < 4; i++)
+    {
+        const float32x4_t column = vld1q_f32(&b[i][0]);
+
+        float32x4_t sum = vmulq_laneq_f32(a0, column, 0);
+        sum = vfmaq_laneq_f32(sum, a1, column, 1);
+        sum = vfmaq_laneq_f32(sum, a2, column, 2);
+        sum = vfmaq_laneq_f32(sum, a3, column, 3);
+
+        vst1q_f32(&result[i][0], sum);
+    }
+#else
+    for (int i = 0; i < 4; i++) result[i] = a[0] * b[i].x + a[1] * b[i].y + a[2] * b[i].z + a[3] * b[i].w;
+#endif
+
+    return result;
+}
+
+// a * b for affine matrices (last row 0, 0, 0, 1), skipping the products with b's known last row
+inline glm::mat4 mat4_multiply_affine(const glm::mat4& a, const glm::mat4& b)
+{
+    glm::mat4 result;
+
+#ifdef SIMD_MATH_SSE2
+    using namespace mat4_math_detail;
+
+    const __m128 columns[4] = {load_column(a, 0), load_column(a, 1), load_column(a, 2), load_column(a, 3)};
+
+    store_column(result, 0, combine_xyz(columns, load_column(b, 0)));
+    store_column(result, 1, combine_xyz(columns, load_column(b, 1)));
+    store_column(result, 2, combine_xyz(columns, load_column(b, 2)));
+    store_column(result, 3, _mm_add_ps(combine_xyz(columns, load_column(b, 3)), columns[3]));
+#else
+    for (int i = 0; i < 3; i++) result[i] = a[0] * b[i].x + a[1] * b[i].y + a[2] * b[i].z;
+
+    result[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+#endif
+
+    return result;
+}
+
+// inverse of a rotation + translation (no scale or shear): the transposed rotation and the negated, rotated translation
+inline glm::mat4 mat4_inverse_rigid(const glm::mat4& m)
+{
+    using namespace mat4_math_detail;
+
+#ifdef SIMD_MATH_SSE2
+    return inverse_rigid_columns(load_column(m, 0), load_column(m, 1), load_column(m, 2), load_column(m, 3));
+#else
+    return inverse_rigid_columns(glm::vec3(m[0]), glm::vec3(m[1]), glm::vec3(m[2]), glm::vec3(m[3]));
+#endif
+}
+
+// view matrix of a camera with an orthonormal right/up/front basis at position, i.e. the inverse of its world transform
+// (columns right, up, -front, position); equal to glm::lookAt(position, position + front, up) without re-deriving the basis
+inline glm::mat4 mat4_view_from_basis(const glm::vec3& right, const glm::vec3& up, const glm::vec3& front, const glm::vec3& position)
+{
+    using namespace mat4_math_detail;
+
+#ifdef SIMD_MATH_SSE2
+    return inverse_rigid_columns(
+        _mm_set_ps(0.f, right.z, right.y, right.x),
+        _mm_set_ps(0.f, up.z, up.y, up.x),
+        _mm_set_ps(0.f, -front.z, -front.y, -front.x),
+        _mm_set_ps(1.f, position.z, position.y, position.x));
+#else
+    return inverse_rigid_columns(right, up, -front, position);
+#endif
+}
+
+// out[i] = left * right[i] for count matrices, e.g. one view-projection applied to every model matrix.
+// out may alias right but not left.
+void mat4_multiply_batch(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, size_t count);
+
+// right-handed look-at, same result as glm::lookAt
+glm::mat4 mat4_look_at(const glm::vec3& eye, const glm::vec3& target, const glm::vec3& up);
+
+#endif // MAT4_MATH_H
@@ -0,0 +1,200 @@
+#include "ProgramBinaryCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../gl_extensions.h"
+#include "../MappedFile.h"
+#include "../utils.h"
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_PROGRAM_BINARY_FORMATS
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+namespace
+{
+    // fixed-size prefix of every cache entry, followed by `length` bytes of driver binary
+    struct entry_header
+    {
+        char magic[4];
+        uint32_t binary_format;
+        uint64_t key; // repeated here so a file-name collision can't restore the wrong program
+        uint64_t length;
+    };
+
+    constexpr char entry_magic[4] = {'P', 'B', 'I', 'N'};
+
+    uint64_t hash_string(const std::string_view text, const uint64_t seed)
+    {
+        // the terminating separator keeps ("ab", "c") and ("a", "bc") apart
+        constexpr unsigned char separator = 0xff;
+
+        return fnv1a_64(&separator, 1, fnv1a_64(reinterpret_cast<const unsigned char*>(text.data()), text.size(), seed));
+    }
+
+    std::string_view gl_string(const GLenum name)
+    {
+        const auto value = reinterpret_cast<const char*>(glGetString(name));
+
+        return value ? value : "";
+    }
+
+    unsigned long process_id()
+    {
+#ifdef _WIN32
+        return static_cast<unsigned long>(_getpid());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+}
+
+ProgramBinaryCache::ProgramBinaryCache(std::string directory) : directory(std::move(directory))
+{
+    if (!has_gl_extension("GL_ARB_get_program_binary")) return;
+
+    get_program_binary = load_gl_function<get_program_binary_function>("glGetProgramBinary");
+    program_binary = load_gl_function<program_binary_function>("glProgramBinary");
+    program_parameter = load_gl_function<program_parameter_function>("glProgramParameteri");
+
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+    // drivers may advertise the extension but offer no format to save in
+    supported = get_program_binary && program_binary && program_parameter && format_count > 0;
+
+    if (!supported) return;
+
+    std::vector<GLint> formats(static_cast<size_t>(format_count));
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    driver_hash = hash_string(gl_string(GL_VENDOR), fnv1a_64_offset_basis);
+    driver_hash = hash_string(gl_string(GL_RENDERER), driver_hash);
+    driver_hash = hash_string(gl_string(GL_VERSION), driver_hash);
+    driver_hash = fnv1a_64(reinterpret_cast<const unsigned char*>(formats.data()), formats.size() * sizeof(GLint), driver_hash);
+}
+
+GLuint ProgramBinaryCache::load(const std::string_view vertex_source, const std::string_view fragment_source) const
+{
+    if (!supported) return 0;
+
+    const uint64_t entry_key = key(vertex_source, fragment_source);
+    const MappedFile file(entry_path(entry_key));
+
+    if (file.size() < sizeof(entry_header)) return 0;
+
+    entry_header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, entry_magic, sizeof(header.magic)) != 0 || header.key != entry_key) return 0;
+    if (header.length > file.size() - sizeof(entry_header)) return 0;
+
+    const GLuint program = glCreateProgram();
+    program_binary(program, header.binary_format, file.data() + sizeof(entry_header), static_cast<GLsizei>(header.length));
+
+    // a binary the driver no longer accepts just fails to link; the caller compiles and stores a fresh one
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void ProgramBinaryCache::prepare_for_link(const GLuint program) const
+{
+    if (supported) program_parameter(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramBinaryCache::store(const GLuint program, const std::string_view vertex_source, const std::string_view fragment_source) const
+{
+    if (!supported) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0) return;
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum binary_format = 0;
+    get_program_binary(program, length, &length, &binary_format, binary.data());
+
+    const uint64_t entry_key = key(vertex_source, fragment_source);
+
+    entry_header header{};
+    std::memcpy(header.magic, entry_magic, sizeof(header.magic));
+    header.binary_format = binary_format;
+    header.key = entry_key;
+    header.length = static_cast<uint64_t>(length);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // written to the side and renamed into place, so a crash or a second instance never leaves a torn entry behind; the
+    // side file is named per process, so two instances storing the same program each write their own and the last rename wins
+    const std::string path = entry_path(entry_key);
+    const std::string temporary_path = path + "." + std::to_string(process_id()) + ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::BINARY_CACHE_WRITE_FAILED: " << temporary_path << '\n';
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path, error);
+
+    if (error)
+    {
+        std::cout << "ERROR::SHADER::BINARY_CACHE_WRITE_FAILED: " << path << '\n';
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+uint64_t ProgramBinaryCache::key(const std::string_view vertex_source, const std::string_view fragment_source) const
+{
+    return hash_string(fragment_source, hash_string(vertex_source, driver_hash));
+}
+
+std::string ProgramBinaryCache::entry_path(const uint64_t entry_key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(entry_key));
+
+    return (std::filesystem::path(directory) / name).string();
+}
@@ -0,0 +1,53 @@
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <glad/glad.h>
+
+// On-disk cache of linked programs (GL_ARB_get_program_binary), so later runs skip compiling and linking GLSL entirely.
+// Entries are keyed by the program's sources and by everything that makes a binary driver-specific: vendor, renderer,
+// version and the binary formats on offer. A driver update therefore just misses, and a binary the driver still rejects
+// falls back to a normal compile that overwrites it.
+class ProgramBinaryCache
+{
+public:
+    // GL thread, with the context current; a cache without driver support stays empty and never touches the disk
+    explicit ProgramBinaryCache(std::string directory);
+
+    ProgramBinaryCache(const ProgramBinaryCache&) = delete;
+    ProgramBinaryCache& operator=(const ProgramBinaryCache&) = delete;
+
+    bool is_supported() const { return supported; }
+
+    // a linked program restored from the cache, or 0 on a miss
+    GLuint load(std::string_view vertex_source, std::string_view fragment_source) const;
+
+    // call between attaching the stages and glLinkProgram, so the driver keeps the binary around for store()
+    void prepare_for_link(GLuint program) const;
+
+    // saves a successfully linked program under the key of its sources
+    void store(GLuint program, std::string_view vertex_source, std::string_view fragment_source) const;
+
+private:
+    using get_program_binary_function = void (APIENTRY*)(GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* binary_format, void* binary);
+    using program_binary_function = void (APIENTRY*)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+    using program_parameter_function = void (APIENTRY*)(GLuint program, GLenum name, GLint value);
+
+    std::string directory;
+    bool supported = false;
+
+    // hash of the driver identity, the seed every entry key starts from
+    uint64_t driver_hash = 0;
+
+    get_program_binary_function get_program_binary = nullptr;
+    program_binary_function program_binary = nullptr;
+    program_parameter_function program_parameter = nullptr;
+
+    uint64_t key(std::string_view vertex_source, std::string_view fragment_source) const;
+    std::string entry_path(uint64_t entry_key) const;
+};
+
+#endif // PROGRAM_BINARY_CACHE_H
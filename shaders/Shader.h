@@ -2,8 +2,8 @@
 #define SHADER_H
 
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -11,91 +11,155 @@
 #include <glm/fwd.hpp>
 #include <glm/gtc/type_ptr.inl>
 
+#include "ProgramBinaryCache.h"
+#include "ShaderPreprocessor.h"
+
+// Fixed binding points for uniform blocks that are shared by every program
+enum uniform_block_binding : GLuint
+{
+    camera_block_binding = 0
+};
+
+// A uniform location resolved once up front, typed by the value it accepts so hot loops can set it without a name lookup
+template <typename T>
+struct uniform_handle
+{
+    GLint location = -1;
+
+    bool is_valid() const { return location != -1; }
+};
+
 class Shader
 {
 public:
+    struct uniform_info
+    {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size;
+    };
+    
     GLuint id;
 
-    Shader(const GLchar* vertex_path, const GLchar* fragment_path)
+    // with a binary cache, a program linked on an earlier run is restored instead of compiled; new programs are stored into it
+    Shader(const GLchar* vertex_path, const GLchar* fragment_path, const ProgramBinaryCache* binary_cache = nullptr)
+        : Shader(preprocess_shader(vertex_path), preprocess_shader(fragment_path), binary_cache)
     {
-        std::ifstream vertex_file;
-        std::ifstream fragment_file;
-        
-        std::string vertex_code_string;
-        std::string fragment_code_string;
-        
-        vertex_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fragment_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    }
 
-        try
+    // sources already run through preprocess_shader, e.g. one permutation of a shader with its defines
+    Shader(const preprocessed_source& vertex, const preprocessed_source& fragment, const ProgramBinaryCache* binary_cache = nullptr)
+    {
+        id = binary_cache ? binary_cache->load(vertex.text, fragment.text) : 0;
+
+        if (id == 0)
         {
-            vertex_file.open(vertex_path);
-            fragment_file.open(fragment_path);
-            
-            std::stringstream vertex_stream, fragment_stream;
+            program_build build = begin_build(vertex.text, fragment.text, binary_cache);
+            finish_build(build, vertex.text, fragment.text, binary_cache);
 
-            vertex_stream << vertex_file.rdbuf();
-            fragment_stream << fragment_file.rdbuf();
+            id = build.program;
+        }
 
-            vertex_file.close();
-            fragment_file.close();
+        cache_uniform_locations();
+        bind_shared_uniform_blocks();
+    }
 
-            vertex_code_string = vertex_stream.str();
-            fragment_code_string = fragment_stream.str();
-        }
-        catch (std::ifstream::failure& error)
-        {
-            std::cout << "ERROR::SHADER::FILE_ERROR: " << error.what() << '\n';
-        }
+    // A program whose stages were handed to the driver but whose status hasn't been queried yet. With parallel shader compile
+    // the driver works on it in the background until finish_build() (or a GL_COMPLETION_STATUS query) asks for the result.
+    struct program_build
+    {
+        GLuint program = 0;
+        GLuint vertex_shader = 0;
+        GLuint fragment_shader = 0;
+    };
 
-        const GLchar* vertex_code = vertex_code_string.c_str();
-        const GLchar* fragment_code = fragment_code_string.c_str();
+    // issues compile and link without querying anything back, so it doesn't wait on the driver
+    static program_build begin_build(const std::string_view vertex_source, const std::string_view fragment_source, const ProgramBinaryCache* binary_cache = nullptr)
+    {
+        // explicit lengths, since views aren't necessarily null-terminated
+        const GLchar* vertex_code = vertex_source.empty() ? "" : vertex_source.data();
+        const GLchar* fragment_code = fragment_source.empty() ? "" : fragment_source.data();
 
-        GLuint vertex_shader_object, fragment_shader_object;
-        
+        const auto vertex_code_length = static_cast<GLint>(vertex_source.size());
+        const auto fragment_code_length = static_cast<GLint>(fragment_source.size());
+
+        program_build build;
+
+        build.vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(build.vertex_shader, 1, &vertex_code, &vertex_code_length);
+        glCompileShader(build.vertex_shader);
+
+        build.fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(build.fragment_shader, 1, &fragment_code, &fragment_code_length);
+        glCompileShader(build.fragment_shader);
+
+        build.program = glCreateProgram();
+
+        glAttachShader(build.program, build.vertex_shader);
+        glAttachShader(build.program, build.fragment_shader);
+
+        if (binary_cache) binary_cache->prepare_for_link(build.program);
+
+        glLinkProgram(build.program);
+
+        return build;
+    }
+
+    // waits for the build if it isn't done yet, reports compile and link errors and releases the shader objects.
+    // returns whether the program linked; it's stored into the binary cache if so. the program is kept either way
+    static bool finish_build(program_build& build, const std::string_view vertex_source, const std::string_view fragment_source, const ProgramBinaryCache* binary_cache = nullptr)
+    {
         GLint success;
         char info_log[512];
 
-        vertex_shader_object = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex_shader_object, 1, &vertex_code, nullptr);
-        glCompileShader(vertex_shader_object);
-
-        glGetShaderiv(vertex_shader_object, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(build.vertex_shader, GL_COMPILE_STATUS, &success);
 
         if (!success)
         {
-            glGetShaderInfoLog(vertex_shader_object, 512, nullptr, info_log);
+            glGetShaderInfoLog(build.vertex_shader, 512, nullptr, info_log);
             std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << info_log << "\n";
         }
 
-        fragment_shader_object = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment_shader_object, 1, &fragment_code, nullptr);
-        glCompileShader(fragment_shader_object);
-
-        glGetShaderiv(fragment_shader_object, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(build.fragment_shader, GL_COMPILE_STATUS, &success);
         
         if (!success)
         {
-            glGetShaderInfoLog(fragment_shader_object, 512, nullptr, info_log);
+            glGetShaderInfoLog(build.fragment_shader, 512, nullptr, info_log);
             std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << info_log << "\n";
         }
 
-        id = glCreateProgram();
+        GLint linked;
+        glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
 
-        glAttachShader(id, vertex_shader_object);
-        glAttachShader(id, fragment_shader_object);
-        glLinkProgram(id);
-
-        glGetProgramiv(id, GL_LINK_STATUS, &success);
-
-        if (!success)
+        if (!linked)
         {
-            glGetProgramInfoLog(id, 512, nullptr, info_log);
+            glGetProgramInfoLog(build.program, 512, nullptr, info_log);
             std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << info_log << "\n";
         }
+        else if (binary_cache)
+        {
+            binary_cache->store(build.program, vertex_source, fragment_source);
+        }
+
+        glDeleteShader(build.vertex_shader);
+        glDeleteShader(build.fragment_shader);
 
-        glDeleteShader(vertex_shader_object);
-        glDeleteShader(fragment_shader_object);
+        build.vertex_shader = 0;
+        build.fragment_shader = 0;
+
+        return linked == GL_TRUE;
+    }
+
+    // takes ownership of a linked program and deletes the current one. uniform locations are looked up again, so handles
+    // from get_uniform() and values set on the old program have to be set again
+    void replace_program(const GLuint program)
+    {
+        glDeleteProgram(id);
+        id = program;
+
+        cache_uniform_locations();
+        bind_shared_uniform_blocks();
     }
 
     void use() const
@@ -103,29 +167,134 @@ public:
         glUseProgram(id);
     }
     
-    void set_bool(const std::string &name, const bool value) const
+    // returns -1 (which glUniform* silently ignores) for names that aren't active uniforms of this program.
+    // takes a string_view so passing a literal never builds a temporary std::string (and never touches the heap)
+    GLint get_uniform_location(const std::string_view name) const
     {
-        glUniform1i(glGetUniformLocation(id, name.c_str()), static_cast<int>(value));
+        const auto found = std::lower_bound(uniforms.begin(), uniforms.end(), name, [](const uniform_info& uniform, const std::string_view key)
+        {
+            return std::string_view(uniform.name) < key;
+        });
+
+        return found != uniforms.end() && found->name == name ? found->location : -1;
+    }
+
+    template <typename T>
+    uniform_handle<T> get_uniform(const std::string_view name) const
+    {
+        return uniform_handle<T>{get_uniform_location(name)};
+    }
+
+    const std::vector<uniform_info>& get_active_uniforms() const
+    {
+        return uniforms;
+    }
+    
+    void set_bool(const std::string_view name, const bool value) const
+    {
+        glUniform1i(get_uniform_location(name), static_cast<int>(value));
+    }
+    
+    void set_int(const std::string_view name, const int value) const
+    {
+        glUniform1i(get_uniform_location(name), value);
+    }
+    
+    void set_float(const std::string_view name, const float value) const
+    {
+        glUniform1f(get_uniform_location(name), value);
+    }
+
+    void set_vec3_f(const std::string_view name, const std::vector<float> &value) const
+    {
+        glUniform3fv(get_uniform_location(name), 1, value.data());
+    }
+
+    void set_mat4(const std::string_view name, const glm::mat4 &value) const
+    {
+        glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    // handle-based setters: no lookup at all, the location was resolved when the handle was created
+    void set(const uniform_handle<bool> handle, const bool value) const
+    {
+        glUniform1i(handle.location, static_cast<int>(value));
     }
     
-    void set_int(const std::string &name, const int value) const
+    void set(const uniform_handle<int> handle, const int value) const
     {
-        glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+        glUniform1i(handle.location, value);
     }
     
-    void set_float(const std::string &name, const float value) const
+    void set(const uniform_handle<float> handle, const float value) const
+    {
+        glUniform1f(handle.location, value);
+    }
+
+    void set(const uniform_handle<glm::vec3> handle, const glm::vec3 &value) const
+    {
+        glUniform3fv(handle.location, 1, glm::value_ptr(value));
+    }
+
+    void set(const uniform_handle<glm::mat4> handle, const glm::mat4 &value) const
     {
-        glUniform1f(glGetUniformLocation(id, name.c_str()), value);
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
     }
 
-    void set_vec3_f(const std::string &name, const std::vector<float> &value) const
+private:
+    void bind_shared_uniform_blocks() const
     {
-        glUniform3fv(glGetUniformLocation(id, name.c_str()), 1, value.data());
+        const GLuint camera_block_index = glGetUniformBlockIndex(id, "Camera");
+
+        if (camera_block_index != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(id, camera_block_index, camera_block_binding);
+        }
     }
+    
+    // flat table of every active uniform, sorted by name so lookups are a binary search instead of a driver string lookup
+    std::vector<uniform_info> uniforms;
 
-    void set_mat4(const std::string &name, const glm::mat4 &value) const
+    void cache_uniform_locations()
     {
-        glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+        GLint uniform_count = 0;
+        GLint max_name_length = 0;
+        
+        glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniform_count);
+        glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+        std::vector<GLchar> name_buffer(static_cast<size_t>(std::max(max_name_length, 1)));
+        
+        uniforms.clear();
+        uniforms.reserve(static_cast<size_t>(uniform_count));
+
+        for (GLint i = 0; i < uniform_count; i++)
+        {
+            GLsizei name_length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            
+            glGetActiveUniform(id, static_cast<GLuint>(i), static_cast<GLsizei>(name_buffer.size()), &name_length, &size, &type, name_buffer.data());
+
+            std::string name(name_buffer.data(), static_cast<size_t>(name_length));
+            const GLint location = glGetUniformLocation(id, name.c_str());
+
+            // uniforms inside named uniform blocks have no location; they're set through their buffer
+            if (location == -1) continue;
+
+            // arrays are reported as "name[0]", but callers address the first element as plain "name" too
+            if (size > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                uniforms.push_back({name.substr(0, name.size() - 3), location, type, size});
+            }
+            
+            uniforms.push_back({std::move(name), location, type, size});
+        }
+
+        std::sort(uniforms.begin(), uniforms.end(), [](const uniform_info& a, const uniform_info& b)
+        {
+            return a.name < b.name;
+        });
     }
 };
 
@@ -0,0 +1,103 @@
+#include "ShaderHotReload.h"
+
+#include <iostream>
+#include <utility>
+
+#include "../gl_extensions.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+ShaderHotReload::ShaderHotReload(std::string vertex_path, std::string fragment_path, shader_defines defines, const ProgramBinaryCache* binary_cache)
+    : vertex_path(std::move(vertex_path)), fragment_path(std::move(fragment_path)), defines(std::move(defines)), binary_cache(binary_cache)
+{
+    watch(preprocess_shader(this->vertex_path, this->defines), preprocess_shader(this->fragment_path, this->defines));
+
+    parallel_compile = has_gl_extension("GL_KHR_parallel_shader_compile") || has_gl_extension("GL_ARB_parallel_shader_compile");
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+    discard_build();
+}
+
+bool ShaderHotReload::update(Shader& shader)
+{
+    if (watcher->poll())
+    {
+        // a newer save supersedes whatever is still compiling
+        discard_build();
+        start_build();
+    }
+
+    if (pending.program == 0 || !is_build_complete()) return false;
+
+    const bool linked = Shader::finish_build(pending, pending_vertex_source, pending_fragment_source, binary_cache);
+
+    if (!linked)
+    {
+        std::cout << "ERROR::SHADER::RELOAD_FAILED: keeping the previous program for " << vertex_path << ", " << fragment_path << '\n';
+        discard_build();
+
+        return false;
+    }
+
+    shader.replace_program(pending.program);
+    pending.program = 0;
+
+    return true;
+}
+
+void ShaderHotReload::watch(const preprocessed_source& vertex, const preprocessed_source& fragment)
+{
+    std::vector<std::string> files = vertex.files;
+    files.insert(files.end(), fragment.files.begin(), fragment.files.end());
+
+    if (watcher && files == watched_files) return;
+
+    watched_files = std::move(files);
+    watcher.emplace(watched_files);
+}
+
+void ShaderHotReload::start_build()
+{
+    preprocessed_source vertex = preprocess_shader(vertex_path, defines);
+    preprocessed_source fragment = preprocess_shader(fragment_path, defines);
+
+    watch(vertex, fragment);
+
+    // editors that save through a rename can leave a file missing for a moment; the rename itself triggers another build
+    if (!vertex.ok || !fragment.ok) return;
+
+    pending_vertex_source = std::move(vertex.text);
+    pending_fragment_source = std::move(fragment.text);
+
+    pending = Shader::begin_build(pending_vertex_source, pending_fragment_source, binary_cache);
+    pending_frames = 0;
+}
+
+bool ShaderHotReload::is_build_complete()
+{
+    if (parallel_compile)
+    {
+        GLint complete = GL_FALSE;
+        glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+
+        return complete == GL_TRUE;
+    }
+
+    // without a completion query, reading any status back waits for the build; give drivers that compile lazily a frame
+    return pending_frames++ > 0;
+}
+
+void ShaderHotReload::discard_build()
+{
+    if (pending.program == 0) return;
+
+    glDeleteShader(pending.vertex_shader);
+    glDeleteShader(pending.fragment_shader);
+    glDeleteProgram(pending.program);
+
+    pending = {};
+}
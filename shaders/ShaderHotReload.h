@@ -0,0 +1,55 @@
+#ifndef SHADER_HOT_RELOAD_H
+#define SHADER_HOT_RELOAD_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "../FileWatcher.h"
+
+// Rebuilds a program whenever one of its source files (includes too) is saved and swaps it into the running Shader once it has linked.
+// With GL_KHR_parallel_shader_compile (or the ARB version) the driver compiles on its own threads and the render loop only
+// polls for completion, so a reload never stalls a frame; without it the build is left to the driver for a frame before the
+// result is read back. A build that fails to compile or link is reported and dropped, and the previous program keeps running.
+class ShaderHotReload
+{
+public:
+    // GL thread, with the context current
+    ShaderHotReload(std::string vertex_path, std::string fragment_path, shader_defines defines = {}, const ProgramBinaryCache* binary_cache = nullptr);
+    ~ShaderHotReload();
+
+    ShaderHotReload(const ShaderHotReload&) = delete;
+    ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+    // GL thread, once per frame. Returns true on the frame a new program replaced the one in `shader`; uniforms set on the
+    // old program and handles taken from it have to be set up again then.
+    bool update(Shader& shader);
+
+private:
+    std::string vertex_path;
+    std::string fragment_path;
+    shader_defines defines;
+    const ProgramBinaryCache* binary_cache;
+
+    // rebuilt whenever an edit changes which files get included
+    std::optional<FileWatcher> watcher;
+    std::vector<std::string> watched_files;
+    bool parallel_compile = false;
+
+    // the build in flight, program == 0 when there is none; its sources are copies, since the files may change again meanwhile
+    Shader::program_build pending;
+    std::string pending_vertex_source;
+    std::string pending_fragment_source;
+    unsigned int pending_frames = 0;
+
+    void watch(const preprocessed_source& vertex, const preprocessed_source& fragment);
+    void start_build();
+    bool is_build_complete();
+    void discard_build();
+};
+
+#endif // SHADER_HOT_RELOAD_H
@@ -0,0 +1,199 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+
+#include "../MappedFile.h"
+#include "../utils.h"
+
+namespace
+{
+    struct expansion
+    {
+        preprocessed_source& result;
+        const shader_defines& defines;
+
+        // files currently being expanded, innermost last; an include of one of them is a cycle
+        std::vector<std::string> include_stack;
+        bool defines_injected = false;
+    };
+
+    std::string_view trim_leading(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+
+        return text;
+    }
+
+    // the directive name of a preprocessor line ("version", "include"...), empty for any other line; `rest` gets what follows it
+    std::string_view directive(const std::string_view line, std::string_view& rest)
+    {
+        std::string_view text = trim_leading(line);
+
+        if (text.empty() || text.front() != '#') return {};
+
+        text = trim_leading(text.substr(1));
+
+        size_t name_length = 0;
+        while (name_length < text.size() && (std::isalpha(static_cast<unsigned char>(text[name_length])) || text[name_length] == '_')) name_length++;
+
+        rest = trim_leading(text.substr(name_length));
+
+        return text.substr(0, name_length);
+    }
+
+    // "file" or <file>, empty if malformed
+    std::string_view include_name(const std::string_view rest)
+    {
+        if (rest.size() < 2) return {};
+
+        const char close = rest.front() == '"' ? '"' : rest.front() == '<' ? '>' : '\0';
+
+        if (close == '\0') return {};
+
+        const size_t end = rest.find(close, 1);
+
+        return end == std::string_view::npos ? std::string_view() : rest.substr(1, end - 1);
+    }
+
+    void append_line_directive(std::string& text, const size_t line, const size_t file_index)
+    {
+        text += "#line ";
+        text += std::to_string(line);
+        text += ' ';
+        text += std::to_string(file_index);
+        text += '\n';
+    }
+
+    void inject_defines(expansion& state, const size_t next_line, const size_t file_index)
+    {
+        for (const shader_define& define : state.defines)
+        {
+            state.result.text += "#define ";
+            state.result.text += define.name;
+
+            if (!define.value.empty())
+            {
+                state.result.text += ' ';
+                state.result.text += define.value;
+            }
+
+            state.result.text += '\n';
+        }
+
+        if (!state.defines.empty()) append_line_directive(state.result.text, next_line, file_index);
+
+        state.defines_injected = true;
+    }
+
+    void expand_file(expansion& state, const std::string& path)
+    {
+        // listed even when missing, so a hot reload keeps watching for it to come back
+        const size_t file_index = state.result.files.size();
+        state.result.files.push_back(path);
+
+        const MappedFile file(path);
+
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::SHADER::FILE_ERROR: " << path << '\n';
+            state.result.ok = false;
+            return;
+        }
+
+        state.include_stack.push_back(path);
+
+        if (file_index > 0) append_line_directive(state.result.text, 1, file_index);
+
+        const std::string_view source = file.text();
+        const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+        size_t line_number = 1;
+
+        for (size_t start = 0; start < source.size(); line_number++)
+        {
+            size_t end = source.find('\n', start);
+            if (end == std::string_view::npos) end = source.size();
+
+            const std::string_view line = source.substr(start, end - start);
+            start = end + 1;
+
+            std::string_view rest;
+            const std::string_view name = directive(line, rest);
+
+            if (name == "include")
+            {
+                const std::string_view included = include_name(rest);
+
+                if (included.empty())
+                {
+                    std::cout << "ERROR::SHADER::MALFORMED_INCLUDE: " << path << ':' << line_number << '\n';
+                    state.result.ok = false;
+                    continue;
+                }
+
+                const std::string included_path = (directory / included).lexically_normal().string();
+
+                if (std::find(state.include_stack.begin(), state.include_stack.end(), included_path) != state.include_stack.end())
+                {
+                    std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE: " << included_path << " from " << path << ':' << line_number << '\n';
+                    state.result.ok = false;
+                    continue;
+                }
+
+                // every file is expanded once per source, so shared snippets don't need include guards
+                if (std::find(state.result.files.begin(), state.result.files.end(), included_path) != state.result.files.end()) continue;
+
+                expand_file(state, included_path);
+                append_line_directive(state.result.text, line_number + 1, file_index);
+
+                continue;
+            }
+
+            state.result.text += line;
+            state.result.text += '\n';
+
+            // defines have to follow #version, which must come first
+            if (name == "version" && !state.defines_injected) inject_defines(state, line_number + 1, file_index);
+        }
+
+        state.include_stack.pop_back();
+    }
+}
+
+preprocessed_source preprocess_shader(const std::string& path, const shader_defines& defines)
+{
+    const shader_defines sorted = sorted_defines(defines);
+
+    preprocessed_source result;
+    expansion state{result, sorted, {}, false};
+
+    expand_file(state, std::filesystem::path(path).lexically_normal().string());
+
+    // no #version: GLSL then defaults to 1.10 and the defines simply go first
+    if (!state.defines_injected && !sorted.empty())
+    {
+        std::string text;
+        std::swap(text, result.text);
+
+        inject_defines(state, 1, 0);
+        result.text += text;
+    }
+
+    result.hash = fnv1a_64(reinterpret_cast<const unsigned char*>(result.text.data()), result.text.size());
+
+    return result;
+}
+
+shader_defines sorted_defines(shader_defines defines)
+{
+    std::sort(defines.begin(), defines.end(), [](const shader_define& a, const shader_define& b)
+    {
+        return a.name < b.name;
+    });
+
+    return defines;
+}
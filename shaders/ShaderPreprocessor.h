@@ -0,0 +1,39 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A compile-time constant injected into a shader as `#define name value`; an empty value just defines the name
+struct shader_define
+{
+    std::string name;
+    std::string value;
+};
+
+using shader_defines = std::vector<shader_define>;
+
+// A shader source ready for glShaderSource, with every include expanded and the permutation defines in place
+struct preprocessed_source
+{
+    std::string text;
+    uint64_t hash = 0;
+
+    // the top-level file first, then every file it included (missing ones too); the index of a file is its GLSL source string number in #line
+    // directives, so driver errors of the form "1(12)" point at line 12 of files[1]
+    std::vector<std::string> files;
+
+    // false if the file or one of its includes couldn't be read (reported already); text is then incomplete
+    bool ok = true;
+};
+
+// Expands `#include "file"` (relative to the including file, each file at most once, so includes need no guards) and injects
+// the defines right after #version, sorted by name so one permutation always produces the same text. #line directives keep
+// line numbers in compile errors pointing into the original files.
+preprocessed_source preprocess_shader(const std::string& path, const shader_defines& defines = {});
+
+// the defines sorted by name, as they are injected
+shader_defines sorted_defines(shader_defines defines);
+
+#endif // SHADER_PREPROCESSOR_H
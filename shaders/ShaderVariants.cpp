@@ -0,0 +1,44 @@
+#include "ShaderVariants.h"
+
+#include "../utils.h"
+
+namespace
+{
+    std::string variant_key(const std::string& vertex_path, const std::string& fragment_path, const shader_defines& sorted)
+    {
+        // '\n' can't appear in a define, so it separates the fields unambiguously
+        std::string key = vertex_path + '\n' + fragment_path;
+
+        for (const shader_define& define : sorted)
+        {
+            key += '\n';
+            key += define.name;
+            key += '=';
+            key += define.value;
+        }
+
+        return key;
+    }
+}
+
+Shader& ShaderVariants::get(const std::string& vertex_path, const std::string& fragment_path, const shader_defines& defines)
+{
+    const shader_defines sorted = sorted_defines(defines);
+    const std::string key = variant_key(vertex_path, fragment_path, sorted);
+
+    if (const auto found = by_key.find(key); found != by_key.end()) return *found->second;
+
+    const preprocessed_source vertex = preprocess_shader(vertex_path, sorted);
+    const preprocessed_source fragment = preprocess_shader(fragment_path, sorted);
+
+    const uint64_t stage_hashes[2] = {vertex.hash, fragment.hash};
+    const uint64_t source_hash = fnv1a_64(reinterpret_cast<const unsigned char*>(stage_hashes), sizeof(stage_hashes));
+
+    std::unique_ptr<Shader>& shader = by_source[source_hash];
+
+    if (!shader) shader = std::make_unique<Shader>(vertex, fragment, binary_cache);
+
+    by_key.emplace(key, shader.get());
+
+    return *shader;
+}
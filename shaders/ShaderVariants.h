@@ -0,0 +1,37 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+// Compiles each permutation of a shader once. Variants are looked up by their files and defines (in any order), and
+// permutations whose expanded sources come out identical share a single program. Together with a ProgramBinaryCache, a
+// variant built on an earlier run is restored instead of compiled.
+class ShaderVariants
+{
+public:
+    explicit ShaderVariants(const ProgramBinaryCache* binary_cache = nullptr) : binary_cache(binary_cache) {}
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // GL thread only. The reference stays valid as long as the cache lives.
+    Shader& get(const std::string& vertex_path, const std::string& fragment_path, const shader_defines& defines = {});
+
+    // distinct programs compiled (or restored) so far
+    size_t program_count() const { return by_source.size(); }
+
+private:
+    const ProgramBinaryCache* binary_cache;
+
+    // key: both paths and the sorted defines, so the same permutation never gets preprocessed twice
+    std::unordered_map<std::string, Shader*> by_key;
+    std::unordered_map<uint64_t, std::unique_ptr<Shader>> by_source;
+};
+
+#endif // SHADER_VARIANTS_H
@@ -0,0 +1,6 @@
+// view/projection shared by every program, bound to camera_block_binding
+layout (std140) uniform Camera
+{
+    mat4 projection_matrix;
+    mat4 view_matrix;
+};
\ No newline at end of file
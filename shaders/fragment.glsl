@@ -1,15 +1,34 @@
 #version 330 core
 
+// permutation keys: variants override them with injected #defines, these are the defaults.
+// how much of the face shows over the container
+#ifndef FACE_MIX
+#define FACE_MIX 0.2
+#endif
+
+// 1 weights the face by its own alpha, so its transparent background leaves the container unmixed
+#ifndef FACE_USE_ALPHA
+#define FACE_USE_ALPHA 0
+#endif
+
 in vec3 our_color;
 in vec2 tex_coord;
 
-uniform sampler2D container_texture;
-uniform sampler2D face_texture;
-uniform float face_alpha;
+// every material image is a layer of one texture array, so switching materials never rebinds a texture
+uniform sampler2DArray material_textures;
+uniform int container_layer;
+uniform int face_layer;
 
 out vec4 frag_color;
 
 void main()
 {
-    frag_color = mix(texture(container_texture, tex_coord), texture(face_texture, vec2(tex_coord.x, tex_coord.y)), 0.2);
+    vec4 container = texture(material_textures, vec3(tex_coord, container_layer));
+    vec4 face = texture(material_textures, vec3(tex_coord, face_layer));
+
+#if FACE_USE_ALPHA
+    frag_color = mix(container, face, FACE_MIX * face.a);
+#else
+    frag_color = mix(container, face, FACE_MIX);
+#endif
 };
\ No newline at end of file
@@ -4,8 +4,8 @@ layout (location = 0) in vec3 a_pos;
 layout (location = 1) in vec2 a_tex_coord;
 
 uniform mat4 model_matrix;
-uniform mat4 view_matrix;
-uniform mat4 projection_matrix;
+
+#include "camera_block.glsl"
 
 out vec3 our_color;
 out vec2 tex_coord;
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 a_pos;
+layout (location = 1) in vec2 a_tex_coord;
+layout (location = 2) in mat4 a_model_matrix;
+
+#include "camera_block.glsl"
+
+out vec3 our_color;
+out vec2 tex_coord;
+
+void main()
+{
+   gl_Position = projection_matrix * view_matrix * a_model_matrix * vec4(a_pos, 1.0);
+
+   tex_coord = a_tex_coord;
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_MATH_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_MATH_SSE2 1
+#endif
+
+// Thin wrappers around SSE/AVX registers so the same kernel source can be instantiated for 4 lanes, 8 lanes, or a plain float
+// (the scalar fallback and the tail of every batch). Each type exposes `lanes`, load/store and the handful of operators the
+// transform, culling and mip filtering kernels need.
+
+struct f32x1
+{
+    static constexpr int lanes = 1;
+    float v;
+
+    static f32x1 load(const float* p) { return {*p}; }
+    static f32x1 broadcast(const float x) { return {x}; }
+    void store(float* p) const { *p = v; }
+
+    friend f32x1 operator+(const f32x1 a, const f32x1 b) { return {a.v + b.v}; }
+    friend f32x1 operator-(const f32x1 a, const f32x1 b) { return {a.v - b.v}; }
+    friend f32x1 operator*(const f32x1 a, const f32x1 b) { return {a.v * b.v}; }
+    friend f32x1 min(const f32x1 a, const f32x1 b) { return {a.v < b.v ? a.v : b.v}; }
+
+    // bit i set when lane i of a >= lane i of b
+    friend int greater_equal_mask(const f32x1 a, const f32x1 b) { return a.v >= b.v ? 1 : 0; }
+
+    // splits the 2 * lanes consecutive floats held in a then b into their even and odd elements
+    friend void deinterleave(const f32x1 a, const f32x1 b, f32x1& even, f32x1& odd) { even = a; odd = b; }
+};
+
+inline void sincos(const f32x1 x, f32x1& s, f32x1& c)
+{
+    s.v = std::sin(x.v);
+    c.v = std::cos(x.v);
+}
+
+#ifdef SIMD_MATH_SSE2
+
+struct f32x4
+{
+    static constexpr int lanes = 4;
+    __m128 v;
+
+    static f32x4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static f32x4 broadcast(const float x) { return {_mm_set1_ps(x)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend f32x4 operator+(const f32x4 a, const f32x4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend f32x4 operator-(const f32x4 a, const f32x4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend f32x4 operator*(const f32x4 a, const f32x4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend f32x4 min(const f32x4 a, const f32x4 b) { return {_mm_min_ps(a.v, b.v)}; }
+
+    friend int greater_equal_mask(const f32x4 a, const f32x4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a.v, b.v)); }
+
+    friend void deinterleave(const f32x4 a, const f32x4 b, f32x4& even, f32x4& odd)
+    {
+        even.v = _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0));
+        odd.v = _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+};
+
+// Cephes-style sincos: reduce to [-pi/4, pi/4] by octant, evaluate both minimax polynomials, then pick and sign them per lane.
+// Max error is a couple of ulp for |x| up to a few thousand radians, which covers any accumulated animation angle.
+inline void sincos(const f32x4 x, f32x4& s, f32x4& c)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+    __m128 abs_x = _mm_andnot_ps(sign_mask, x.v);
+    __m128 sin_sign = _mm_and_ps(x.v, sign_mask);
+
+    // octant index, rounded up to even so the remainder is centred on a multiple of pi/2
+    __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(abs_x, _mm_set1_ps(1.27323954473516f)));
+    octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    const __m128 y = _mm_cvtepi32_ps(octant);
+
+    // extended-precision subtraction of octant * pi/4
+    abs_x = _mm_sub_ps(abs_x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+    abs_x = _mm_sub_ps(abs_x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+    abs_x = _mm_sub_ps(abs_x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+
+    const __m128i swap_sin_cos = _mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_set1_epi32(2));
+    const __m128 poly_mask = _mm_castsi128_ps(swap_sin_cos);
+
+    sin_sign = _mm_xor_ps(sin_sign, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29)));
+    const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+
+    const __m128 z = _mm_mul_ps(abs_x, abs_x);
+
+    __m128 cos_poly = _mm_set1_ps(2.443315711809948e-5f);
+    cos_poly = _mm_add_ps(_mm_mul_ps(cos_poly, z), _mm_set1_ps(-1.388731625493765e-3f));
+    cos_poly = _mm_add_ps(_mm_mul_ps(cos_poly, z), _mm_set1_ps(4.166664568298827e-2f));
+    cos_poly = _mm_mul_ps(_mm_mul_ps(cos_poly, z), z);
+    cos_poly = _mm_sub_ps(cos_poly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    cos_poly = _mm_add_ps(cos_poly, _mm_set1_ps(1.f));
+
+    __m128 sin_poly = _mm_set1_ps(-1.9515295891e-4f);
+    sin_poly = _mm_add_ps(_mm_mul_ps(sin_poly, z), _mm_set1_ps(8.3321608736e-3f));
+    sin_poly = _mm_add_ps(_mm_mul_ps(sin_poly, z), _mm_set1_ps(-1.6666654611e-1f));
+    sin_poly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_poly, z), abs_x), abs_x);
+
+    const __m128 sin_value = _mm_or_ps(_mm_and_ps(poly_mask, cos_poly), _mm_andnot_ps(poly_mask, sin_poly));
+    const __m128 cos_value = _mm_or_ps(_mm_and_ps(poly_mask, sin_poly), _mm_andnot_ps(poly_mask, cos_poly));
+
+    s.v = _mm_xor_ps(sin_value, sin_sign);
+    c.v = _mm_xor_ps(cos_value, cos_sign);
+}
+
+#endif // SIMD_MATH_SSE2
+
+#ifdef SIMD_MATH_AVX2
+
+struct f32x8
+{
+    static constexpr int lanes = 8;
+    __m256 v;
+
+    static f32x8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static f32x8 broadcast(const float x) { return {_mm256_set1_ps(x)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    friend f32x8 operator+(const f32x8 a, const f32x8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend f32x8 operator-(const f32x8 a, const f32x8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend f32x8 operator*(const f32x8 a, const f32x8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    friend f32x8 min(const f32x8 a, const f32x8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+
+    friend int greater_equal_mask(const f32x8 a, const f32x8 b) { return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+
+    // the in-lane shuffle leaves 128-bit halves interleaved as a0a2 b0b2 | a4a6 b4b6, so reorder the 64-bit pairs afterwards
+    friend void deinterleave(const f32x8 a, const f32x8 b, f32x8& even, f32x8& odd)
+    {
+        even.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+        odd.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+
+// 8-lane version of the f32x4 sincos above; same reduction and polynomials
+inline void sincos(const f32x8 x, f32x8& s, f32x8& c)
+{
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+    __m256 abs_x = _mm256_andnot_ps(sign_mask, x.v);
+    __m256 sin_sign = _mm256_and_ps(x.v, sign_mask);
+
+    __m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(abs_x, _mm256_set1_ps(1.27323954473516f)));
+    octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    const __m256 y = _mm256_cvtepi32_ps(octant);
+
+    abs_x = _mm256_sub_ps(abs_x, _mm256_mul_ps(y, _mm256_set1_ps(0.78515625f)));
+    abs_x = _mm256_sub_ps(abs_x, _mm256_mul_ps(y, _mm256_set1_ps(2.4187564849853515625e-4f)));
+    abs_x = _mm256_sub_ps(abs_x, _mm256_mul_ps(y, _mm256_set1_ps(3.77489497744594108e-8f)));
+
+    const __m256i swap_sin_cos = _mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(2));
+    const __m256 poly_mask = _mm256_castsi256_ps(swap_sin_cos);
+
+    sin_sign = _mm256_xor_ps(sin_sign, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29)));
+    const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+
+    const __m256 z = _mm256_mul_ps(abs_x, abs_x);
+
+    __m256 cos_poly = _mm256_set1_ps(2.443315711809948e-5f);
+    cos_poly = _mm256_add_ps(_mm256_mul_ps(cos_poly, z), _mm256_set1_ps(-1.388731625493765e-3f));
+    cos_poly = _mm256_add_ps(_mm256_mul_ps(cos_poly, z), _mm256_set1_ps(4.166664568298827e-2f));
+    cos_poly = _mm256_mul_ps(_mm256_mul_ps(cos_poly, z), z);
+    cos_poly = _mm256_sub_ps(cos_poly, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+    cos_poly = _mm256_add_ps(cos_poly, _mm256_set1_ps(1.f));
+
+    __m256 sin_poly = _mm256_set1_ps(-1.9515295891e-4f);
+    sin_poly = _mm256_add_ps(_mm256_mul_ps(sin_poly, z), _mm256_set1_ps(8.3321608736e-3f));
+    sin_poly = _mm256_add_ps(_mm256_mul_ps(sin_poly, z), _mm256_set1_ps(-1.6666654611e-1f));
+    sin_poly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sin_poly, z), abs_x), abs_x);
+
+    const __m256 sin_value = _mm256_blendv_ps(sin_poly, cos_poly, poly_mask);
+    const __m256 cos_value = _mm256_blendv_ps(cos_poly, sin_poly, poly_mask);
+
+    s.v = _mm256_xor_ps(sin_value, sin_sign);
+    c.v = _mm256_xor_ps(cos_value, cos_sign);
+}
+
+#endif // SIMD_MATH_AVX2
+
+// Widest lane type the build enables
+#if defined(SIMD_MATH_AVX2)
+using f32xn = f32x8;
+#elif defined(SIMD_MATH_SSE2)
+using f32xn = f32x4;
+#else
+using f32xn = f32x1;
+#endif
+
+#endif // SIMD_MATH_H
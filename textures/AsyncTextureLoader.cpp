@@ -0,0 +1,509 @@
+#include "AsyncTextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "../stb_image.h"
+#include "../gl_extensions.h"
+#include "../utils.h"
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace
+{
+    // build mip chains on the decode workers; flip to false to hand them back to glGenerateMipmap on the GL thread.
+    // Array layers always get theirs on the worker: glGenerateMipmap would rebuild every layer of the array.
+    constexpr bool build_mips_on_workers = true;
+
+    using buffer_storage_function = void (APIENTRY*)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    GLenum pixel_format(const int channels)
+    {
+        switch (channels)
+        {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+        }
+    }
+}
+
+AsyncTextureLoader::AsyncTextureLoader(const unsigned int worker_count)
+{
+    create_staging_buffers();
+
+    supports_s3tc = has_gl_extension("GL_EXT_texture_compression_s3tc");
+    supports_bptc = has_gl_extension("GL_ARB_texture_compression_bptc");
+
+    for (unsigned int i = 0; i < std::max(worker_count, 1u); i++)
+    {
+        workers.emplace_back(&AsyncTextureLoader::worker_loop, this);
+    }
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    job_available.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (staging_buffer& buffer : staging_buffers)
+    {
+        if (buffer.fence) glDeleteSync(buffer.fence);
+
+        if (persistent_mapping)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        glDeleteBuffers(1, &buffer.id);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+unsigned int AsyncTextureLoader::default_worker_count()
+{
+    // leave one hardware thread for the render loop
+    const unsigned int hardware_threads = std::thread::hardware_concurrency();
+
+    return hardware_threads > 1 ? hardware_threads - 1 : 1;
+}
+
+GLuint AsyncTextureLoader::load(const std::string& path)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // placeholder until the real image arrives; with a single level the texture is already mipmap-complete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder_pixel);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_jobs.push_back({path, texture, -1, 0});
+    }
+
+    job_available.notify_one();
+    outstanding_count++;
+
+    return texture;
+}
+
+void AsyncTextureLoader::load_layer(const std::string& path, const GLuint array_texture, const GLint layer, const GLenum array_format)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_jobs.push_back({path, array_texture, layer, array_format});
+    }
+
+    job_available.notify_one();
+    outstanding_count++;
+}
+
+bool AsyncTextureLoader::supports_compressed_format(const GLenum internal_format) const
+{
+    block_format blocks;
+
+    if (!block_format_from_gl(internal_format, blocks)) return false;
+
+    return blocks == block_format::bc7 ? supports_bptc : supports_s3tc;
+}
+
+void AsyncTextureLoader::upload_finished(size_t byte_budget)
+{
+    bool uploaded_any = false;
+    
+    while (outstanding_count > 0)
+    {
+        decoded_image image;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (decoded_images.empty()) return;
+
+            const decoded_image& next = decoded_images.front();
+            const size_t image_size = next.byte_size();
+
+            // always let at least one image through so a texture bigger than the budget still makes progress
+            if (image_size > byte_budget && uploaded_any) return;
+
+            if (!next.levels.empty() && image_size <= staging_buffer_size && !acquire_staging_buffer()) return;
+
+            image = std::move(decoded_images.front());
+            decoded_images.pop_front();
+            byte_budget -= std::min(byte_budget, image_size);
+        }
+
+        upload(image);
+        uploaded_any = true;
+    }
+}
+
+void AsyncTextureLoader::finish_all()
+{
+    while (outstanding_count > 0)
+    {
+        decoded_image image;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            image_decoded.wait(lock, [this] { return !decoded_images.empty(); });
+
+            image = std::move(decoded_images.front());
+            decoded_images.pop_front();
+        }
+
+        upload(image);
+    }
+}
+
+bool AsyncTextureLoader::is_idle() const
+{
+    return outstanding_count == 0;
+}
+
+void AsyncTextureLoader::worker_loop()
+{
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    while (true)
+    {
+        decode_job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_available.wait(lock, [this] { return stopping || !pending_jobs.empty(); });
+
+            if (stopping) return;
+
+            job = std::move(pending_jobs.front());
+            pending_jobs.pop_front();
+        }
+
+        decoded_image image;
+        image.path = std::move(job.path);
+        image.texture = job.texture;
+        image.layer = job.layer;
+        image.array_format = job.array_format;
+
+        const bool cooked = image.path.size() > 5 && image.path.compare(image.path.size() - 5, 5, ".ctex") == 0;
+
+        if (cooked)
+        {
+            map_cooked(image);
+        }
+        else
+        {
+            decode_source(image);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded_images.push_back(std::move(image));
+        }
+
+        image_decoded.notify_one();
+    }
+}
+
+void AsyncTextureLoader::create_staging_buffers()
+{
+    // persistently mapped buffers (GL_ARB_buffer_storage) stay mapped for their whole life, so uploads are a plain memcpy
+    const auto buffer_storage = has_gl_extension("GL_ARB_buffer_storage")
+        ? load_gl_function<buffer_storage_function>("glBufferStorage")
+        : nullptr;
+
+    persistent_mapping = buffer_storage != nullptr;
+
+    const GLbitfield persistent_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    for (staging_buffer& buffer : staging_buffers)
+    {
+        glGenBuffers(1, &buffer.id);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+
+        if (persistent_mapping)
+        {
+            buffer_storage(GL_PIXEL_UNPACK_BUFFER, staging_buffer_size, nullptr, persistent_flags);
+            buffer.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, staging_buffer_size, persistent_flags);
+        }
+        else
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, staging_buffer_size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// Next staging buffer in the ring if the GPU has finished reading from it, nullptr otherwise
+AsyncTextureLoader::staging_buffer* AsyncTextureLoader::acquire_staging_buffer()
+{
+    staging_buffer& buffer = staging_buffers[next_staging_buffer];
+
+    if (buffer.fence)
+    {
+        const GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return nullptr;
+
+        glDeleteSync(buffer.fence);
+        buffer.fence = nullptr;
+    }
+
+    return &buffer;
+}
+
+void AsyncTextureLoader::upload(const decoded_image& image)
+{
+    outstanding_count--;
+
+    const bool failed = image.levels.empty();
+    const bool skip_upload = before_upload && before_upload(image.texture, failed ? 0 : image.content_hash);
+
+    if (failed)
+    {
+        std::cout << "ERROR::TEXTURE::LOAD_FAILED: " << image.path << '\n';
+        return;
+    }
+
+    if (skip_upload) return;
+
+    const size_t image_size = image.byte_size();
+    staging_buffer* buffer = nullptr;
+
+    if (image_size <= staging_buffer_size)
+    {
+        buffer = acquire_staging_buffer();
+
+        // finish_all() may get here with the ring still busy; waiting is fine there since it blocks anyway
+        while (!buffer)
+        {
+            glClientWaitSync(staging_buffers[next_staging_buffer].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            buffer = acquire_staging_buffer();
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->id);
+
+        unsigned char* destination;
+
+        if (persistent_mapping)
+        {
+            destination = static_cast<unsigned char*>(buffer->mapped);
+        }
+        else
+        {
+            // orphan, then map the fresh storage so the copy never waits on an upload still in flight
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, staging_buffer_size, nullptr, GL_STREAM_DRAW);
+            destination = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(image_size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        }
+
+        // every level back to back; they're read from the same offsets below
+        for (const texture_level& level : image.levels)
+        {
+            std::memcpy(destination, level.data, level.size);
+            destination += level.size;
+        }
+
+        if (!persistent_mapping) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    const bool array_layer = image.layer >= 0;
+
+    // a single level is an image whose mip chain still has to be built by the driver. Never for a layer: that would regenerate
+    // every layer of the array (overwriting uploaded chains and reading pending ones) and isn't allowed on compressed arrays;
+    // a layer only uploads the levels it brought
+    const bool generate_mipmaps = !array_layer && image.levels.size() == 1;
+    const GLenum target = array_layer ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+
+    glActiveTexture(GL_TEXTURE0 + upload_texture_unit);
+    glBindTexture(target, image.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // array storage and its level range were fixed when the array was created
+    if (!array_layer)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, generate_mipmaps ? 1000 : static_cast<GLint>(image.levels.size()) - 1);
+    }
+
+    size_t offset = 0;
+
+    for (size_t i = 0; i < image.levels.size(); i++)
+    {
+        const texture_level& level = image.levels[i];
+
+        // with a pixel unpack buffer bound, the data pointer is an offset into it
+        const void* source = buffer ? reinterpret_cast<const void*>(offset) : level.data;
+        offset += level.size;
+
+        const auto level_index = static_cast<GLint>(i);
+
+        if (array_layer && image.compressed)
+        {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level_index, 0, 0, image.layer, level.width, level.height, 1, image.internal_format, static_cast<GLsizei>(level.size), source);
+        }
+        else if (array_layer)
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level_index, 0, 0, image.layer, level.width, level.height, 1, image.format, image.type, source);
+        }
+        else if (image.compressed)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level_index, image.internal_format, level.width, level.height, 0, static_cast<GLsizei>(level.size), source);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level_index, static_cast<GLint>(image.internal_format), level.width, level.height, 0, image.format, image.type, source);
+        }
+    }
+
+    if (generate_mipmaps) glGenerateMipmap(target);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(target, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (buffer)
+    {
+        buffer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next_staging_buffer = (next_staging_buffer + 1) % staging_buffer_count;
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
+
+void AsyncTextureLoader::image_deleter::operator()(unsigned char* pixels) const
+{
+    stbi_image_free(pixels);
+}
+
+size_t AsyncTextureLoader::decoded_image::byte_size() const
+{
+    size_t size = 0;
+
+    for (const texture_level& level : levels)
+    {
+        size += level.size;
+    }
+
+    return size;
+}
+
+// Worker thread: reads and decodes a plain image file, then builds its mip chain
+void AsyncTextureLoader::decode_source(decoded_image& image)
+{
+    // hash the encoded bytes rather than the pixels: it's cheaper and identical files decode identically
+    const MappedFile file(image.path);
+
+    if (file.size() == 0) return;
+
+    image.content_hash = fnv1a_64(file.data(), file.size());
+
+    int width, height, channels;
+    image.pixels.reset(stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 0));
+
+    if (!image.pixels) return;
+
+    image.format = pixel_format(channels);
+    image.internal_format = image.format;
+    image.levels.push_back({image.pixels.get(), static_cast<size_t>(width) * height * channels, width, height});
+
+    if (!build_mips_on_workers && image.layer < 0) return;
+
+    image.mips = build_mip_levels(image.pixels.get(), width, height, channels);
+
+    for (const mip_level& mip : image.mips)
+    {
+        image.levels.push_back({mip.pixels.data(), mip.pixels.size(), mip.width, mip.height});
+    }
+}
+
+// Worker thread: maps a cooked file and points the levels straight into the mapping, nothing is decoded or copied unless
+// the blocks are in a format the driver can't sample
+void AsyncTextureLoader::map_cooked(decoded_image& image) const
+{
+    image.mapping = MappedFile(image.path);
+
+    cooked_texture_view view;
+
+    if (!parse_cooked_texture(image.mapping.data(), image.mapping.size(), view)) return;
+
+    image.internal_format = view.header->gl_internal_format;
+    image.format = view.header->gl_format;
+    image.type = view.header->gl_type;
+    image.compressed = (view.header->flags & cooked_texture_compressed) != 0;
+    image.content_hash = view.header->content_hash;
+
+    block_format blocks = block_format::bc1;
+
+    if (image.compressed && !block_format_from_gl(image.internal_format, blocks)) return;
+
+    // an array layer also has to match the format the array was allocated in
+    const bool supported = !image.compressed
+        || (supports_compressed_format(image.internal_format) && (image.layer < 0 || image.array_format == image.internal_format));
+
+    for (size_t i = 0; i < view.levels.size(); i++)
+    {
+        const cooked_texture_level& level = view.levels[i];
+        const auto width = static_cast<GLsizei>(level.width);
+        const auto height = static_cast<GLsizei>(level.height);
+
+        if (supported)
+        {
+            image.levels.push_back({view.level_data[i], static_cast<size_t>(level.size), width, height});
+            continue;
+        }
+
+        mip_level decoded{std::vector<unsigned char>(static_cast<size_t>(width) * height * 4), width, height};
+
+        // either failure leaves no levels, so the texture keeps its placeholder instead of getting a partial chain
+        if (level.size < compressed_image_size(blocks, width, height)
+            || !decompress_image(view.level_data[i], width, height, blocks, decoded.pixels.data()))
+        {
+            image.levels.clear();
+            image.mips.clear();
+            return;
+        }
+
+        image.mips.push_back(std::move(decoded));
+        image.levels.push_back({image.mips.back().pixels.data(), image.mips.back().pixels.size(), width, height});
+    }
+
+    if (!supported)
+    {
+        image.compressed = false;
+        image.internal_format = GL_RGBA8;
+        image.format = GL_RGBA;
+        image.type = GL_UNSIGNED_BYTE;
+    }
+}
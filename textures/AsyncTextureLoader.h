@@ -0,0 +1,151 @@
+#ifndef ASYNC_TEXTURE_LOADER_H
+#define ASYNC_TEXTURE_LOADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "MipChain.h"
+#include "../MappedFile.h"
+
+// Decodes images on worker threads and uploads them through a small ring of pixel buffer objects on the GL thread.
+// load() hands back a texture name right away; it holds a 1x1 placeholder until upload_finished() swaps the real image in,
+// so the render loop can bind it from the first frame without waiting on disk or decode.
+// Workers also build the mip chain of decoded images, so the GL thread only uploads. Cooked .ctex files skip decoding
+// entirely: the worker only maps the file and the stored mip chain is uploaded as is, block-compressed ones included
+// (they are decoded on the worker instead when the driver lacks the format).
+class AsyncTextureLoader
+{
+public:
+    explicit AsyncTextureLoader(unsigned int worker_count = default_worker_count());
+    ~AsyncTextureLoader();
+
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+    // GL thread only. The texture is created with repeat wrapping, trilinear minification and nearest magnification.
+    GLuint load(const std::string& path);
+
+    // GL thread only. Uploads the image into one layer of an existing GL_TEXTURE_2D_ARRAY whose levels are already allocated
+    // in `array_format`; cooked blocks in any other format are decoded on the worker first.
+    void load_layer(const std::string& path, GLuint array_texture, GLint layer, GLenum array_format);
+
+    // whether cooked blocks in this compressed internal format can be uploaded as they are
+    bool supports_compressed_format(GLenum internal_format) const;
+
+    // GL thread only, once per frame. Uploads decoded images while a free staging buffer is available and the byte budget
+    // lasts; never waits for the GPU or the workers. Uploads bind through upload_texture_unit, so textures the render loop
+    // bound elsewhere stay bound; texture unit 0 is left active.
+    void upload_finished(size_t byte_budget = default_upload_budget);
+
+    // GL thread only. Blocks until every requested texture has been decoded and uploaded.
+    void finish_all();
+
+    bool is_idle() const;
+
+    static unsigned int default_worker_count();
+
+    // Called on the GL thread for every finished request, right before its image is uploaded into `texture`, with a hash of
+    // the encoded source file (0 if it couldn't be read or decoded, in which case nothing is uploaded either way).
+    // Returning true skips the upload, e.g. because an identical image is already resident under another texture.
+    std::function<bool(GLuint texture, uint64_t content_hash)> before_upload;
+
+    static constexpr size_t default_upload_budget = 16 * 1024 * 1024;
+
+    // the last unit GL 3.3 guarantees to fragment shaders; keep it free of material textures
+    static constexpr GLuint upload_texture_unit = 15;
+
+    // RGBA colour a texture shows until its image arrives: neutral grey
+    static constexpr unsigned char placeholder_pixel[4] = {128, 128, 128, 255};
+
+private:
+    struct decode_job
+    {
+        std::string path;
+        GLuint texture;
+        GLint layer;        // -1 for a plain 2D texture
+        GLenum array_format;
+    };
+
+    struct image_deleter
+    {
+        void operator()(unsigned char* pixels) const;
+    };
+
+    struct texture_level
+    {
+        const unsigned char* data;
+        size_t size;
+        GLsizei width;
+        GLsizei height;
+    };
+
+    // Pixels ready to upload, pointing either into a decoded image or into a mapped cooked file; `levels` is empty on failure
+    struct decoded_image
+    {
+        std::string path;
+        GLuint texture = 0;
+        GLint layer = -1;
+        GLenum array_format = 0;
+        GLenum internal_format = GL_RGBA;
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        bool compressed = false;
+        std::vector<texture_level> levels;
+        uint64_t content_hash = 0;
+
+        std::unique_ptr<unsigned char, image_deleter> pixels;
+        std::vector<mip_level> mips;
+        MappedFile mapping;
+
+        size_t byte_size() const;
+    };
+
+    struct staging_buffer
+    {
+        GLuint id = 0;
+        void* mapped = nullptr;
+        GLsync fence = nullptr;
+    };
+
+    static constexpr size_t staging_buffer_count = 4;
+    static constexpr size_t staging_buffer_size = 8 * 1024 * 1024;
+
+    std::vector<std::thread> workers;
+    std::deque<decode_job> pending_jobs;
+    std::deque<decoded_image> decoded_images;
+    mutable std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable image_decoded;
+    bool stopping = false;
+
+    // textures requested but not uploaded yet; only touched on the GL thread
+    size_t outstanding_count = 0;
+
+    staging_buffer staging_buffers[staging_buffer_count];
+    size_t next_staging_buffer = 0;
+    bool persistent_mapping = false;
+
+    // queried on the GL thread before the workers start, read-only afterwards
+    bool supports_s3tc = false;
+    bool supports_bptc = false;
+
+    void worker_loop();
+    void create_staging_buffers();
+    staging_buffer* acquire_staging_buffer();
+    void upload(const decoded_image& image);
+
+    static void decode_source(decoded_image& image);
+    void map_cooked(decoded_image& image) const;
+};
+
+#endif // ASYNC_TEXTURE_LOADER_H
@@ -0,0 +1,746 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    // a 4x4 block of RGBA texels, row-major, first row at the lowest address
+    using block_texels = unsigned char[16][4];
+
+    void fetch_block(const unsigned char* pixels, const int width, const int height, const int channels, const int block_x, const int block_y, block_texels texels)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            const int source_y = std::min(block_y * 4 + y, height - 1);
+
+            for (int x = 0; x < 4; x++)
+            {
+                const int source_x = std::min(block_x * 4 + x, width - 1);
+                const unsigned char* source = pixels + (static_cast<size_t>(source_y) * width + source_x) * channels;
+                unsigned char* texel = texels[y * 4 + x];
+
+                texel[0] = source[0];
+                texel[1] = source[1];
+                texel[2] = source[2];
+                texel[3] = channels == 4 ? source[3] : 255;
+            }
+        }
+    }
+
+    // Principal axis of the texels' first `dimensions` channels, by power iteration on their covariance matrix
+    void principal_axis(const block_texels texels, const int dimensions, float mean[4], float axis[4])
+    {
+        for (int c = 0; c < dimensions; c++)
+        {
+            float sum = 0.f;
+
+            for (int i = 0; i < 16; i++) sum += texels[i][c];
+
+            mean[c] = sum / 16.f;
+        }
+
+        float covariance[4][4] = {};
+
+        for (int i = 0; i < 16; i++)
+        {
+            for (int a = 0; a < dimensions; a++)
+            {
+                for (int b = a; b < dimensions; b++)
+                {
+                    covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+                }
+            }
+        }
+
+        for (int a = 0; a < dimensions; a++)
+        {
+            for (int b = 0; b < a; b++) covariance[a][b] = covariance[b][a];
+        }
+
+        for (int c = 0; c < dimensions; c++) axis[c] = 1.f;
+
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            float length = 0.f;
+
+            for (int a = 0; a < dimensions; a++)
+            {
+                for (int b = 0; b < dimensions; b++) next[a] += covariance[a][b] * axis[b];
+
+                length = std::max(length, std::abs(next[a]));
+            }
+
+            // flat block: any axis will do
+            if (length < 1e-6f) break;
+
+            for (int c = 0; c < dimensions; c++) axis[c] = next[c] / length;
+        }
+    }
+
+    // The two points where the texels' projection onto the principal axis starts and ends
+    void fit_endpoints(const block_texels texels, const int dimensions, float first[4], float second[4])
+    {
+        float mean[4], axis[4];
+        principal_axis(texels, dimensions, mean, axis);
+
+        float length_squared = 0.f;
+
+        for (int c = 0; c < dimensions; c++) length_squared += axis[c] * axis[c];
+
+        float min_t = 0.f, max_t = 0.f;
+
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.f;
+
+            for (int c = 0; c < dimensions; c++) t += (texels[i][c] - mean[c]) * axis[c];
+
+            t /= length_squared;
+            min_t = std::min(min_t, t);
+            max_t = std::max(max_t, t);
+        }
+
+        for (int c = 0; c < dimensions; c++)
+        {
+            first[c] = std::clamp(mean[c] + axis[c] * max_t, 0.f, 255.f);
+            second[c] = std::clamp(mean[c] + axis[c] * min_t, 0.f, 255.f);
+        }
+    }
+
+    // Least-squares endpoints for fixed indices, where texel i is reconstructed as weights[i] * first + (1 - weights[i]) * second.
+    // Returns false when every texel uses the same weight and the system is singular.
+    bool refine_endpoints(const block_texels texels, const int dimensions, const float weights[16], float first[4], float second[4])
+    {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ax[4] = {}, bx[4] = {};
+
+        for (int i = 0; i < 16; i++)
+        {
+            const float a = weights[i];
+            const float b = 1.f - a;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+
+            for (int c = 0; c < dimensions; c++)
+            {
+                ax[c] += a * texels[i][c];
+                bx[c] += b * texels[i][c];
+            }
+        }
+
+        const float determinant = aa * bb - ab * ab;
+
+        if (std::abs(determinant) < 1e-6f) return false;
+
+        for (int c = 0; c < dimensions; c++)
+        {
+            first[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+            second[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+        }
+
+        return true;
+    }
+
+    // --- BC1 colour ---------------------------------------------------------------------------------------------------------
+
+    uint16_t quantize_565(const float color[4])
+    {
+        const auto r = static_cast<unsigned int>(std::lround(color[0] * 31.f / 255.f));
+        const auto g = static_cast<unsigned int>(std::lround(color[1] * 63.f / 255.f));
+        const auto b = static_cast<unsigned int>(std::lround(color[2] * 31.f / 255.f));
+
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    void expand_565(const uint16_t packed, int color[3])
+    {
+        const int r = packed >> 11 & 31;
+        const int g = packed >> 5 & 63;
+        const int b = packed & 31;
+
+        color[0] = r << 3 | r >> 2;
+        color[1] = g << 2 | g >> 4;
+        color[2] = b << 3 | b >> 2;
+    }
+
+    // 4-colour palette; `three_color` selects the colour0 <= colour1 mode, whose last entry is transparent black
+    void bc1_palette(const uint16_t color0, const uint16_t color1, const bool three_color, int palette[4][4])
+    {
+        expand_565(color0, palette[0]);
+        expand_565(color1, palette[1]);
+        palette[0][3] = palette[1][3] = 255;
+
+        for (int c = 0; c < 3; c++)
+        {
+            if (three_color)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            else
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+        }
+
+        palette[2][3] = 255;
+        palette[3][3] = three_color ? 0 : 255;
+    }
+
+    // Picks the nearest palette entry for every texel; returns the packed indices and the squared error
+    uint32_t bc1_indices(const block_texels texels, const int palette[4][4], int& error)
+    {
+        uint32_t indices = 0;
+        error = 0;
+
+        for (int i = 0; i < 16; i++)
+        {
+            int best_index = 0;
+            int best_distance = INT32_MAX;
+
+            for (int p = 0; p < 4; p++)
+            {
+                int distance = 0;
+
+                for (int c = 0; c < 3; c++)
+                {
+                    const int delta = texels[i][c] - palette[p][c];
+                    distance += delta * delta;
+                }
+
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_index = p;
+                }
+            }
+
+            indices |= static_cast<uint32_t>(best_index) << (2 * i);
+            error += best_distance;
+        }
+
+        return indices;
+    }
+
+    // Always uses the 4-colour mode: BC3 ignores the endpoint order, and opaque BC1 has no use for the transparent entry
+    void encode_bc1_color(const block_texels texels, unsigned char* output)
+    {
+        // weight of the first endpoint for each 4-colour index
+        constexpr float index_weights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+        float first[4], second[4];
+        fit_endpoints(texels, 3, first, second);
+
+        uint16_t best_color0 = 0, best_color1 = 0;
+        uint32_t best_indices = 0;
+        int best_error = INT32_MAX;
+
+        for (int iteration = 0; iteration < 3; iteration++)
+        {
+            uint16_t color0 = quantize_565(first);
+            uint16_t color1 = quantize_565(second);
+
+            // the decoder reads colour0 <= colour1 as the 3-colour mode
+            if (color0 < color1) std::swap(color0, color1);
+
+            int palette[4][4];
+            bc1_palette(color0, color1, false, palette);
+
+            int error;
+            uint32_t indices = bc1_indices(texels, palette, error);
+
+            // a single colour: only index 0 decodes to it in both modes
+            if (color0 == color1) indices = 0;
+
+            if (error < best_error)
+            {
+                best_error = error;
+                best_color0 = color0;
+                best_color1 = color1;
+                best_indices = indices;
+            }
+
+            if (error == 0 || color0 == color1) break;
+
+            float weights[16];
+
+            for (int i = 0; i < 16; i++) weights[i] = index_weights[indices >> (2 * i) & 3];
+
+            if (!refine_endpoints(texels, 3, weights, first, second)) break;
+        }
+
+        output[0] = static_cast<unsigned char>(best_color0);
+        output[1] = static_cast<unsigned char>(best_color0 >> 8);
+        output[2] = static_cast<unsigned char>(best_color1);
+        output[3] = static_cast<unsigned char>(best_color1 >> 8);
+        std::memcpy(output + 4, &best_indices, 4);
+    }
+
+    void decode_bc1_color(const unsigned char* block, const bool allow_three_color, block_texels texels)
+    {
+        const uint16_t color0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+        const uint16_t color1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+
+        uint32_t indices;
+        std::memcpy(&indices, block + 4, 4);
+
+        int palette[4][4];
+        bc1_palette(color0, color1, allow_three_color && color0 <= color1, palette);
+
+        for (int i = 0; i < 16; i++)
+        {
+            const int* entry = palette[indices >> (2 * i) & 3];
+
+            for (int c = 0; c < 4; c++) texels[i][c] = static_cast<unsigned char>(entry[c]);
+        }
+    }
+
+    // --- BC3 alpha ----------------------------------------------------------------------------------------------------------
+
+    void alpha_palette(const int alpha0, const int alpha1, int palette[8])
+    {
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+
+        if (alpha0 > alpha1)
+        {
+            for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; i++) palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // 8-value mode spanning the block's alpha range; blocks that are entirely opaque or transparent come out exact
+    void encode_bc3_alpha(const block_texels texels, unsigned char* output)
+    {
+        int alpha0 = 0, alpha1 = 255;
+
+        for (int i = 0; i < 16; i++)
+        {
+            alpha0 = std::max<int>(alpha0, texels[i][3]);
+            alpha1 = std::min<int>(alpha1, texels[i][3]);
+        }
+
+        uint64_t indices = 0;
+
+        if (alpha0 != alpha1)
+        {
+            int palette[8];
+            alpha_palette(alpha0, alpha1, palette);
+
+            for (int i = 0; i < 16; i++)
+            {
+                int best_index = 0;
+
+                for (int p = 1; p < 8; p++)
+                {
+                    if (std::abs(texels[i][3] - palette[p]) < std::abs(texels[i][3] - palette[best_index])) best_index = p;
+                }
+
+                indices |= static_cast<uint64_t>(best_index) << (3 * i);
+            }
+        }
+
+        output[0] = static_cast<unsigned char>(alpha0);
+        output[1] = static_cast<unsigned char>(alpha1);
+
+        for (int i = 0; i < 6; i++) output[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+    }
+
+    void decode_bc3_alpha(const unsigned char* block, block_texels texels)
+    {
+        int palette[8];
+        alpha_palette(block[0], block[1], palette);
+
+        uint64_t indices = 0;
+
+        for (int i = 0; i < 6; i++) indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+
+        for (int i = 0; i < 16; i++) texels[i][3] = static_cast<unsigned char>(palette[indices >> (3 * i) & 7]);
+    }
+
+    // --- BC7 mode 6 ---------------------------------------------------------------------------------------------------------
+
+    constexpr int bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // 128-bit little-endian bit stream, filled and read from bit 0 upwards
+    struct block_bits
+    {
+        uint64_t words[2] = {};
+        int position = 0;
+
+        void write(const uint32_t value, const int count)
+        {
+            for (int i = 0; i < count; i++, position++)
+            {
+                words[position >> 6] |= static_cast<uint64_t>(value >> i & 1) << (position & 63);
+            }
+        }
+
+        uint32_t read(const int count)
+        {
+            uint32_t value = 0;
+
+            for (int i = 0; i < count; i++, position++)
+            {
+                value |= static_cast<uint32_t>(words[position >> 6] >> (position & 63) & 1) << i;
+            }
+
+            return value;
+        }
+    };
+
+    // Mode 6 endpoints are 7 bits per channel plus a low bit shared by all four channels, given here as `p_bit`
+    void quantize_bc7_endpoint(const float endpoint[4], const int p_bit, int quantized[4])
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            quantized[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - p_bit) / 2.f)), 0, 127);
+        }
+    }
+
+    // Alpha 255 needs an odd p-bit (127 << 1 | 1) and alpha 0 an even one. Squared error would trade either away for a
+    // closer colour, which turns opaque texels slightly translucent, so an endpoint at either extreme keeps its exact p-bit
+    bool keeps_bc7_alpha_exact(const float endpoint[4], const int p_bit)
+    {
+        const long alpha = std::lround(endpoint[3]);
+
+        if (alpha >= 255) return p_bit == 1;
+        if (alpha <= 0) return p_bit == 0;
+
+        return true;
+    }
+
+    // picks the closest palette entry for every texel and returns the summed squared error
+    int assign_bc7_indices(const block_texels texels, const int endpoints[2][4], const int p_bits[2], int indices[16])
+    {
+        int palette[16][4];
+
+        for (int c = 0; c < 4; c++)
+        {
+            const int value0 = endpoints[0][c] << 1 | p_bits[0];
+            const int value1 = endpoints[1][c] << 1 | p_bits[1];
+
+            for (int w = 0; w < 16; w++)
+            {
+                palette[w][c] = ((64 - bc7_weights[w]) * value0 + bc7_weights[w] * value1 + 32) >> 6;
+            }
+        }
+
+        int error = 0;
+
+        for (int i = 0; i < 16; i++)
+        {
+            int best_distance = INT32_MAX;
+
+            for (int w = 0; w < 16; w++)
+            {
+                int distance = 0;
+
+                for (int c = 0; c < 4; c++)
+                {
+                    const int delta = texels[i][c] - palette[w][c];
+                    distance += delta * delta;
+                }
+
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    indices[i] = w;
+                }
+            }
+
+            error += best_distance;
+        }
+
+        return error;
+    }
+
+    void encode_bc7_block(const block_texels texels, unsigned char* output)
+    {
+        float first[4], second[4];
+        fit_endpoints(texels, 4, first, second);
+
+        int best_endpoints[2][4] = {};
+        int best_p_bits[2] = {};
+        int best_indices[16] = {};
+        int best_error = INT32_MAX;
+
+        // an odd p-bit is the only way an endpoint's alpha reaches 255, and plain error would trade that for a closer colour,
+        // so opaque blocks always use it; other blocks try every pair of p-bits and keep whichever reconstructs best
+        bool opaque = true;
+
+        for (int i = 0; i < 16; i++) opaque = opaque && texels[i][3] == 255;
+
+        const int first_p_bit_pair = opaque ? 3 : 0;
+
+        for (int iteration = 0; iteration < 3; iteration++)
+        {
+            int endpoints[2][4];
+            int p_bits[2];
+            int indices[16];
+            int error = INT32_MAX;
+
+            for (int pair = 0; pair < 4; pair++)
+            {
+                int candidate_endpoints[2][4];
+                const int candidate_p_bits[2] = {pair & 1, pair >> 1};
+                int candidate_indices[16];
+
+                if (!keeps_bc7_alpha_exact(first, candidate_p_bits[0]) || !keeps_bc7_alpha_exact(second, candidate_p_bits[1])) continue;
+
+                quantize_bc7_endpoint(first, candidate_p_bits[0], candidate_endpoints[0]);
+                quantize_bc7_endpoint(second, candidate_p_bits[1], candidate_endpoints[1]);
+
+                const int candidate_error = assign_bc7_indices(texels, candidate_endpoints, candidate_p_bits, candidate_indices);
+
+                if (candidate_error < error)
+                {
+                    error = candidate_error;
+                    std::memcpy(endpoints, candidate_endpoints, sizeof(endpoints));
+                    std::memcpy(p_bits, candidate_p_bits, sizeof(p_bits));
+                    std::memcpy(indices, candidate_indices, sizeof(indices));
+                }
+            }
+
+            if (error < best_error)
+            {
+                best_error = error;
+                std::memcpy(best_endpoints, endpoints, sizeof(endpoints));
+                std::memcpy(best_p_bits, p_bits, sizeof(p_bits));
+                std::memcpy(best_indices, indices, sizeof(indices));
+            }
+
+            if (error == 0) break;
+
+            float weights[16];
+
+            for (int i = 0; i < 16; i++) weights[i] = 1.f - bc7_weights[indices[i]] / 64.f;
+
+            if (!refine_endpoints(texels, 4, weights, first, second)) break;
+        }
+
+        // the first texel's index is stored with its top bit implied zero, so flip the whole block around if it's set
+        if (best_indices[0] >= 8)
+        {
+            std::swap(best_endpoints[0], best_endpoints[1]);
+            std::swap(best_p_bits[0], best_p_bits[1]);
+
+            for (int& index : best_indices) index = 15 - index;
+        }
+
+        block_bits bits;
+        bits.write(1 << 6, 7);
+
+        for (int c = 0; c < 4; c++)
+        {
+            bits.write(static_cast<uint32_t>(best_endpoints[0][c]), 7);
+            bits.write(static_cast<uint32_t>(best_endpoints[1][c]), 7);
+        }
+
+        bits.write(static_cast<uint32_t>(best_p_bits[0]), 1);
+        bits.write(static_cast<uint32_t>(best_p_bits[1]), 1);
+
+        for (int i = 0; i < 16; i++) bits.write(static_cast<uint32_t>(best_indices[i]), i == 0 ? 3 : 4);
+
+        std::memcpy(output, bits.words, 16);
+    }
+
+    bool decode_bc7_block(const unsigned char* block, block_texels texels)
+    {
+        block_bits bits;
+        std::memcpy(bits.words, block, 16);
+
+        if (bits.read(7) != 1 << 6) return false;
+
+        int values[2][4];
+
+        for (int c = 0; c < 4; c++)
+        {
+            values[0][c] = static_cast<int>(bits.read(7)) << 1;
+            values[1][c] = static_cast<int>(bits.read(7)) << 1;
+        }
+
+        const int p0 = static_cast<int>(bits.read(1));
+        const int p1 = static_cast<int>(bits.read(1));
+
+        for (int c = 0; c < 4; c++)
+        {
+            values[0][c] |= p0;
+            values[1][c] |= p1;
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            const int weight = bc7_weights[bits.read(i == 0 ? 3 : 4)];
+
+            for (int c = 0; c < 4; c++)
+            {
+                texels[i][c] = static_cast<unsigned char>(((64 - weight) * values[0][c] + weight * values[1][c] + 32) >> 6);
+            }
+        }
+
+        return true;
+    }
+
+    void encode_block(const block_format format, const block_texels texels, unsigned char* output)
+    {
+        switch (format)
+        {
+        case block_format::bc1:
+            encode_bc1_color(texels, output);
+            break;
+        case block_format::bc3:
+            encode_bc3_alpha(texels, output);
+            encode_bc1_color(texels, output + 8);
+            break;
+        case block_format::bc7:
+            encode_bc7_block(texels, output);
+            break;
+        }
+    }
+
+    bool decode_block(const block_format format, const unsigned char* block, block_texels texels)
+    {
+        switch (format)
+        {
+        case block_format::bc1:
+            decode_bc1_color(block, true, texels);
+            return true;
+        case block_format::bc3:
+            decode_bc1_color(block + 8, false, texels);
+            decode_bc3_alpha(block, texels);
+            return true;
+        case block_format::bc7:
+            return decode_bc7_block(block, texels);
+        }
+
+        return false;
+    }
+
+    int blocks_across(const int pixels)
+    {
+        return (std::max(pixels, 1) + 3) / 4;
+    }
+}
+
+size_t block_size(const block_format format)
+{
+    return format == block_format::bc1 ? 8 : 16;
+}
+
+size_t compressed_image_size(const block_format format, const int width, const int height)
+{
+    return static_cast<size_t>(blocks_across(width)) * blocks_across(height) * block_size(format);
+}
+
+GLenum gl_compressed_format(const block_format format)
+{
+    switch (format)
+    {
+    case block_format::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case block_format::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+}
+
+bool block_format_from_gl(const GLenum internal_format, block_format& format)
+{
+    switch (internal_format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: format = block_format::bc1; return true;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: format = block_format::bc3; return true;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: format = block_format::bc7; return true;
+    default: return false;
+    }
+}
+
+std::vector<unsigned char> compress_image(const unsigned char* pixels, const int width, const int height, const int channels, const block_format format,
+                                          unsigned int thread_count)
+{
+    if (!pixels || width <= 0 || height <= 0 || channels < 3 || channels > 4) return {};
+
+    const int columns = blocks_across(width);
+    const int rows = blocks_across(height);
+    const size_t row_size = columns * block_size(format);
+
+    std::vector<unsigned char> blocks(row_size * rows);
+
+    // rows are handed out one at a time, so threads that hit cheap (flat) rows simply take more of them
+    std::atomic<int> next_row{0};
+
+    const auto encode_rows = [&]
+    {
+        block_texels texels;
+
+        for (int row = next_row++; row < rows; row = next_row++)
+        {
+            unsigned char* output = blocks.data() + row * row_size;
+
+            for (int column = 0; column < columns; column++)
+            {
+                fetch_block(pixels, width, height, channels, column, row, texels);
+                encode_block(format, texels, output + column * block_size(format));
+            }
+        }
+    };
+
+    if (thread_count == 0) thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    thread_count = std::min(thread_count, static_cast<unsigned int>(rows));
+
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 1; i < thread_count; i++)
+    {
+        threads.emplace_back(encode_rows);
+    }
+
+    encode_rows();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return blocks;
+}
+
+bool decompress_image(const unsigned char* blocks, const int width, const int height, const block_format format, unsigned char* rgba_pixels)
+{
+    const int columns = blocks_across(width);
+    const int rows = blocks_across(height);
+
+    block_texels texels;
+
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            if (!decode_block(format, blocks + (static_cast<size_t>(row) * columns + column) * block_size(format), texels)) return false;
+
+            for (int y = 0; y < 4 && row * 4 + y < height; y++)
+            {
+                for (int x = 0; x < 4 && column * 4 + x < width; x++)
+                {
+                    std::memcpy(rgba_pixels + ((static_cast<size_t>(row) * 4 + y) * width + column * 4 + x) * 4, texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+
+    return true;
+}
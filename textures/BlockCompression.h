@@ -0,0 +1,48 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+// 4x4 block formats the encoder can produce
+enum class block_format : uint8_t
+{
+    bc1, // 8 bytes per block, opaque RGB (DXT1)
+    bc3, // 16 bytes per block, BC1 colour plus an interpolated alpha block (DXT5)
+    bc7  // 16 bytes per block, RGBA; this encoder only emits mode 6 (one subset, 4-bit indices)
+};
+
+size_t block_size(block_format format);
+
+// bytes of a whole level; partial blocks at the right and top edges count as full ones
+size_t compressed_image_size(block_format format, int width, int height);
+
+GLenum gl_compressed_format(block_format format);
+
+// false if `internal_format` isn't one of the formats above
+bool block_format_from_gl(GLenum internal_format, block_format& format);
+
+// Encodes a tightly packed 8-bit RGB or RGBA image. Rows of blocks are spread over `thread_count` threads
+// (0 = one per hardware thread); edge blocks repeat the last row/column.
+std::vector<unsigned char> compress_image(const unsigned char* pixels, int width, int height, int channels, block_format format, unsigned int thread_count = 0);
+
+// Decodes blocks into tightly packed RGBA. Used for quality measurements and as the upload fallback when the driver lacks
+// the format; returns false on BC7 blocks in modes other than 6.
+bool decompress_image(const unsigned char* blocks, int width, int height, block_format format, unsigned char* rgba_pixels);
+
+#endif // BLOCK_COMPRESSION_H
@@ -0,0 +1,271 @@
+#include "CookedTexture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <glad/glad.h>
+
+#include "BlockCompression.h"
+#include "MipChain.h"
+#include "../MappedFile.h"
+#include "../stb_image.h"
+#include "../utils.h"
+
+namespace
+{
+    constexpr size_t level_alignment = 16;
+
+    // far beyond any GL_MAX_TEXTURE_SIZE, and small enough that a level's byte count can't overflow
+    constexpr uint32_t max_dimension = 1u << 16;
+
+    size_t align_up(const size_t value, const size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    struct image_format
+    {
+        GLenum internal_format;
+        GLenum format;
+    };
+
+    image_format format_for_channels(const int channels)
+    {
+        switch (channels)
+        {
+        case 1: return {GL_R8, GL_RED};
+        case 2: return {GL_RG8, GL_RG};
+        case 3: return {GL_RGB8, GL_RGB};
+        default: return {GL_RGBA8, GL_RGBA};
+        }
+    }
+
+    bool has_translucent_texels(const unsigned char* pixels, const size_t texel_count, const int channels)
+    {
+        if (channels != 4) return false;
+
+        for (size_t i = 0; i < texel_count; i++)
+        {
+            if (pixels[i * 4 + 3] != 255) return true;
+        }
+
+        return false;
+    }
+
+    // bytes of one texel in an uncompressed level, 0 for a format/type pair the cooker never writes
+    size_t texel_size(const uint32_t format, const uint32_t type)
+    {
+        if (type != GL_UNSIGNED_BYTE) return 0;
+
+        switch (format)
+        {
+        case GL_RED: return 1;
+        case GL_RG: return 2;
+        case GL_RGB: return 3;
+        case GL_RGBA: return 4;
+        default: return 0;
+        }
+    }
+}
+
+std::string cooked_texture_path(const std::string& source_path)
+{
+    const size_t slash = source_path.find_last_of("/\\");
+    const size_t dot = source_path.find_last_of('.');
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return source_path + ".ctex";
+
+    return source_path.substr(0, dot) + ".ctex";
+}
+
+bool parse_cook_compression(const std::string_view name, cook_compression& compression)
+{
+    if (name == "none") compression = cook_compression::none;
+    else if (name == "auto") compression = cook_compression::automatic;
+    else if (name == "bc1") compression = cook_compression::bc1;
+    else if (name == "bc3") compression = cook_compression::bc3;
+    else if (name == "bc7") compression = cook_compression::bc7;
+    else return false;
+
+    return true;
+}
+
+bool cook_texture(const std::string& source_path, const std::string& destination_path, cook_compression compression)
+{
+    const MappedFile source_file(source_path);
+
+    if (source_file.size() == 0)
+    {
+        std::cout << "ERROR::COOK::SOURCE_NOT_READ: " << source_path << '\n';
+        return false;
+    }
+
+    // same orientation the runtime decoder uses, so level 0 is bottom row first like glTexImage2D expects
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load_from_memory(source_file.data(), static_cast<int>(source_file.size()), &width, &height, &channels, 0);
+
+    stbi_set_flip_vertically_on_load_thread(false);
+
+    if (!pixels)
+    {
+        std::cout << "ERROR::COOK::DECODE_FAILED: " << source_path << '\n';
+        return false;
+    }
+
+    // offline, so it can afford the sharper (and several times slower) filter
+    mip_options options;
+    options.filter = mip_filter::kaiser;
+
+    std::vector<mip_level> level_pixels;
+    level_pixels.push_back({std::vector<unsigned char>(pixels, pixels + static_cast<size_t>(width) * height * channels), width, height});
+
+    std::vector<mip_level> mips = build_mip_levels(pixels, width, height, channels, options);
+    stbi_image_free(pixels);
+
+    level_pixels.insert(level_pixels.end(), std::make_move_iterator(mips.begin()), std::make_move_iterator(mips.end()));
+
+    if (compression != cook_compression::none && channels < 3)
+    {
+        if (compression != cook_compression::automatic) std::cout << "ERROR::COOK::NOT_COMPRESSIBLE: " << source_path << " has " << channels << " channels" << '\n';
+
+        compression = cook_compression::none;
+    }
+
+    if (compression == cook_compression::automatic)
+    {
+        const bool translucent = has_translucent_texels(level_pixels[0].pixels.data(), static_cast<size_t>(width) * height, channels);
+        compression = translucent ? cook_compression::bc7 : cook_compression::bc1;
+    }
+
+    image_format format = format_for_channels(channels);
+    uint32_t flags = 0;
+
+    if (compression != cook_compression::none)
+    {
+        const block_format blocks = compression == cook_compression::bc1 ? block_format::bc1
+            : compression == cook_compression::bc3 ? block_format::bc3
+            : block_format::bc7;
+
+        for (mip_level& level : level_pixels)
+        {
+            level.pixels = compress_image(level.pixels.data(), level.width, level.height, channels, blocks);
+        }
+
+        // what the blocks decode to, should the runtime have to fall back
+        format = {gl_compressed_format(blocks), GL_RGBA};
+        flags |= cooked_texture_compressed;
+    }
+
+    std::vector<cooked_texture_level> levels;
+
+    for (const mip_level& level : level_pixels)
+    {
+        levels.push_back({0, level.pixels.size(), static_cast<uint32_t>(level.width), static_cast<uint32_t>(level.height)});
+    }
+
+    cooked_texture_header header{};
+    std::memcpy(header.magic, cooked_texture_magic, sizeof(header.magic));
+    header.version = cooked_texture_version;
+    header.gl_internal_format = format.internal_format;
+    header.gl_format = format.format;
+    header.gl_type = GL_UNSIGNED_BYTE;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.level_count = static_cast<uint32_t>(levels.size());
+    header.flags = flags;
+    header.content_hash = fnv1a_64(source_file.data(), source_file.size());
+
+    size_t offset = sizeof(header) + levels.size() * sizeof(cooked_texture_level);
+
+    for (cooked_texture_level& level : levels)
+    {
+        offset = align_up(offset, level_alignment);
+        level.offset = offset;
+        offset += level.size;
+    }
+
+    std::ofstream file(destination_path, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::COOK::DESTINATION_NOT_WRITABLE: " << destination_path << '\n';
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(cooked_texture_level)));
+
+    constexpr char padding[level_alignment] = {};
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        const auto position = static_cast<size_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(levels[i].offset - position));
+        file.write(reinterpret_cast<const char*>(level_pixels[i].pixels.data()), static_cast<std::streamsize>(level_pixels[i].pixels.size()));
+    }
+
+    if (!file)
+    {
+        std::cout << "ERROR::COOK::WRITE_FAILED: " << destination_path << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+bool parse_cooked_texture(const unsigned char* data, const size_t size, cooked_texture_view& view)
+{
+    if (!data || size < sizeof(cooked_texture_header)) return false;
+
+    const auto* header = reinterpret_cast<const cooked_texture_header*>(data);
+
+    if (std::memcmp(header->magic, cooked_texture_magic, sizeof(header->magic)) != 0) return false;
+    if (header->version != cooked_texture_version || header->level_count == 0) return false;
+
+    const size_t table_end = sizeof(cooked_texture_header) + static_cast<size_t>(header->level_count) * sizeof(cooked_texture_level);
+
+    if (header->level_count > 32 || table_end > size) return false;
+    if (header->width == 0 || header->height == 0 || header->width > max_dimension || header->height > max_dimension) return false;
+
+    const bool compressed = (header->flags & cooked_texture_compressed) != 0;
+    block_format blocks = block_format::bc1;
+    const size_t pixel_size = texel_size(header->gl_format, header->gl_type);
+
+    if (compressed ? !block_format_from_gl(header->gl_internal_format, blocks) : pixel_size == 0) return false;
+
+    view.header = header;
+    view.levels.resize(header->level_count);
+    view.level_data.resize(header->level_count);
+
+    // the level table is 8-byte aligned within the file, but copy it out anyway rather than rely on the mapping's alignment
+    std::memcpy(view.levels.data(), data + sizeof(cooked_texture_header), view.levels.size() * sizeof(cooked_texture_level));
+
+    for (size_t i = 0; i < view.levels.size(); i++)
+    {
+        const cooked_texture_level& level = view.levels[i];
+
+        if (level.offset < table_end || level.offset > size || level.size > size - level.offset) return false;
+
+        // each level halves the previous one, and holds exactly the bytes its dimensions and format call for, so the
+        // uploader never reads past a level that claims more texels than it has
+        const uint32_t width = std::max(header->width >> i, 1u);
+        const uint32_t height = std::max(header->height >> i, 1u);
+
+        if (level.width != width || level.height != height) return false;
+
+        const size_t expected_size = compressed
+            ? compressed_image_size(blocks, static_cast<int>(width), static_cast<int>(height))
+            : static_cast<size_t>(width) * height * pixel_size;
+
+        if (level.size != expected_size) return false;
+
+        view.level_data[i] = data + level.offset;
+    }
+
+    return true;
+}
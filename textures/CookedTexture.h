@@ -0,0 +1,76 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Layout of a cooked texture (.ctex): the header, then `level_count` level entries, then each level's pixels tightly packed,
+// already in the GL format/type the header names and ordered bottom row first, exactly as glTexImage2D consumes them.
+// With cooked_texture_compressed set, levels are instead 4x4 blocks in gl_internal_format, ready for glCompressedTexImage2D,
+// and gl_format/gl_type describe what they decode to. Level data starts on a 16-byte boundary. All fields are little-endian,
+// like every platform this builds for.
+struct cooked_texture_header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t gl_internal_format;
+    uint32_t gl_format;
+    uint32_t gl_type;
+    uint32_t width;
+    uint32_t height;
+    uint32_t level_count;
+    uint32_t flags; // cooked_texture_* bits
+    uint32_t reserved;
+    uint64_t content_hash; // FNV-1a of the source image file, so cooked and raw copies of one image dedupe together
+};
+
+struct cooked_texture_level
+{
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+static_assert(sizeof(cooked_texture_header) == 48, "cooked_texture_header must match the on-disk layout");
+static_assert(sizeof(cooked_texture_level) == 24, "cooked_texture_level must match the on-disk layout");
+
+constexpr char cooked_texture_magic[4] = {'C', 'T', 'E', 'X'};
+constexpr uint32_t cooked_texture_version = 1;
+
+constexpr uint32_t cooked_texture_compressed = 1u << 0;
+
+enum class cook_compression : uint8_t
+{
+    none,
+    automatic, // BC1 for opaque images, BC7 when any texel is translucent; 1- and 2-channel images stay uncompressed
+    bc1,
+    bc3,
+    bc7
+};
+
+// Read-only view into a mapped .ctex file; the pointers stay valid as long as the mapping does
+struct cooked_texture_view
+{
+    const cooked_texture_header* header = nullptr;
+    std::vector<const unsigned char*> level_data;
+    std::vector<cooked_texture_level> levels;
+};
+
+// "assets/container.jpg" -> "assets/container.ctex"
+std::string cooked_texture_path(const std::string& source_path);
+
+// Decodes `source_path`, builds its full mip chain, block-compresses it as requested and writes the result to
+// `destination_path`. Offline tool, no GL needed.
+bool cook_texture(const std::string& source_path, const std::string& destination_path, cook_compression compression = cook_compression::automatic);
+
+// "none", "auto", "bc1", "bc3" or "bc7"
+bool parse_cook_compression(std::string_view name, cook_compression& compression);
+
+// Validates the header and every level against `size`, so a truncated or foreign file is rejected rather than read past
+bool parse_cooked_texture(const unsigned char* data, size_t size, cooked_texture_view& view);
+
+#endif // COOKED_TEXTURE_H
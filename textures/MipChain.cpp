@@ -0,0 +1,343 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../simd_math.h"
+
+namespace
+{
+    constexpr int max_filter_taps = 8;
+
+    // Separable 2:1 downsampling kernel: output texel x reads source texels 2x + first_tap .. 2x + first_tap + tap_count - 1
+    struct filter_kernel
+    {
+        int first_tap;
+        int tap_count; // always even, so taps can be consumed in deinterleaved pairs
+        float weights[max_filter_taps];
+    };
+
+    double bessel_i0(const double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 32; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    filter_kernel make_kernel(const mip_filter filter)
+    {
+        if (filter == mip_filter::box) return {0, 2, {0.5f, 0.5f}};
+
+        // sinc cut off at the new Nyquist limit, windowed over +-2 destination texels
+        constexpr double beta = 4.0;
+        constexpr double window_radius = 2.0;
+        constexpr double pi = 3.14159265358979323846;
+
+        filter_kernel kernel{-3, 8, {}};
+        double total = 0.0;
+        double weights[max_filter_taps];
+
+        for (int k = 0; k < kernel.tap_count; k++)
+        {
+            // distance from the output texel centre (source coordinate 2x + 1) in destination texels
+            const double t = (kernel.first_tap + k + 0.5 - 1.0) / 2.0;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+            const double r = t / window_radius;
+            const double window = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel_i0(beta);
+
+            weights[k] = sinc * window;
+            total += weights[k];
+        }
+
+        for (int k = 0; k < kernel.tap_count; k++)
+        {
+            kernel.weights[k] = static_cast<float>(weights[k] / total);
+        }
+
+        return kernel;
+    }
+
+    // sRGB transfer tables. Encoding rounds exactly: a coarse table gives a first guess that is at most one code low, and the
+    // midpoints between neighbouring codes settle it.
+    struct srgb_tables
+    {
+        static constexpr int guess_resolution = 4096;
+
+        float to_linear[256];
+        float unorm_to_float[256];
+        float code_midpoints[255];
+        unsigned char guess[guess_resolution + 1];
+
+        srgb_tables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                to_linear[i] = decode(i / 255.0);
+                unorm_to_float[i] = static_cast<float>(i / 255.0);
+            }
+
+            for (int i = 0; i < 255; i++)
+            {
+                code_midpoints[i] = decode((i + 0.5) / 255.0);
+            }
+
+            int code = 0;
+
+            for (int i = 0; i <= guess_resolution; i++)
+            {
+                const float linear = static_cast<float>(i) / guess_resolution;
+
+                while (code < 255 && linear > code_midpoints[code]) code++;
+
+                guess[i] = static_cast<unsigned char>(code);
+            }
+        }
+
+        static float decode(const double encoded)
+        {
+            return static_cast<float>(encoded <= 0.04045 ? encoded / 12.92 : std::pow((encoded + 0.055) / 1.055, 2.4));
+        }
+
+        // linear is already clamped to [0, 1]
+        unsigned char encode(const float linear) const
+        {
+            int code = guess[static_cast<int>(linear * guess_resolution)];
+
+            while (code < 255 && linear > code_midpoints[code]) code++;
+
+            return static_cast<unsigned char>(code);
+        }
+    };
+
+    const srgb_tables& get_srgb_tables()
+    {
+        static const srgb_tables tables;
+        return tables;
+    }
+
+    int alpha_channel(const int channels)
+    {
+        return channels == 2 || channels == 4 ? channels - 1 : -1;
+    }
+
+    // Interleaved 8-bit pixels to one float plane per channel, linearized and premultiplied as requested. Runs channel by
+    // channel so every inner loop is a branch-free table lookup.
+    void decode_to_planes(const unsigned char* pixels, const int width, const int height, const int channels, const mip_options& options, float* planes)
+    {
+        const srgb_tables& srgb = get_srgb_tables();
+        const size_t texel_count = static_cast<size_t>(width) * height;
+        const int alpha = alpha_channel(channels);
+
+        for (int c = 0; c < channels; c++)
+        {
+            const unsigned char* source = pixels + c;
+            float* const plane = planes + c * texel_count;
+            const float* const table = options.srgb && c != alpha ? srgb.to_linear : srgb.unorm_to_float;
+
+            if (c == alpha || alpha < 0 || !options.premultiply_alpha)
+            {
+                for (size_t i = 0; i < texel_count; i++)
+                {
+                    plane[i] = table[source[i * channels]];
+                }
+            }
+            else
+            {
+                const unsigned char* coverage = pixels + alpha;
+
+                for (size_t i = 0; i < texel_count; i++)
+                {
+                    plane[i] = table[source[i * channels]] * srgb.unorm_to_float[coverage[i * channels]];
+                }
+            }
+        }
+    }
+
+    // Requantizes the planes into interleaved 8-bit pixels, undoing premultiplication. The planes are left untouched since
+    // the next level is filtered from them.
+    void encode_from_planes(const float* planes, const int width, const int height, const int channels, const mip_options& options, unsigned char* pixels)
+    {
+        const srgb_tables& srgb = get_srgb_tables();
+        const size_t texel_count = static_cast<size_t>(width) * height;
+        const int alpha = alpha_channel(channels);
+        const float* const coverage = alpha >= 0 && options.premultiply_alpha ? planes + alpha * texel_count : nullptr;
+
+        // sharpening filters overshoot, so everything is clamped before it's requantized
+        const auto saturate = [](const float value) { return std::min(std::max(value, 0.f), 1.f); };
+
+        for (int c = 0; c < channels; c++)
+        {
+            const float* const plane = planes + c * texel_count;
+            unsigned char* destination = pixels + c;
+
+            if (c == alpha || !options.srgb)
+            {
+                for (size_t i = 0; i < texel_count; i++)
+                {
+                    float value = plane[i];
+
+                    if (coverage && c != alpha) value = coverage[i] > 0.f ? value / saturate(coverage[i]) : 0.f;
+
+                    destination[i * channels] = static_cast<unsigned char>(saturate(value) * 255.f + 0.5f);
+                }
+            }
+            else if (coverage)
+            {
+                for (size_t i = 0; i < texel_count; i++)
+                {
+                    const float value = coverage[i] > 0.f ? plane[i] / saturate(coverage[i]) : 0.f;
+                    destination[i * channels] = srgb.encode(saturate(value));
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < texel_count; i++)
+                {
+                    destination[i * channels] = srgb.encode(saturate(plane[i]));
+                }
+            }
+        }
+    }
+
+    // One plane, one 2:1 step: a vertical pass over whole source rows into `row` (which has room for padding on both
+    // sides), then a horizontal pass over the edge-padded row, reading each pair of taps with one deinterleaved load pair
+    template <typename V>
+    void downsample_plane(const float* source, const int width, const int height, float* destination, const int next_width, const int next_height,
+                          const filter_kernel& kernel, float* row)
+    {
+        const int pad_left = std::max(-kernel.first_tap, 0);
+        const int padded_end = pad_left + std::max(width, 2 * next_width) + kernel.tap_count + 2 * V::lanes;
+        float* const row_start = row + pad_left;
+
+        for (int y = 0; y < next_height; y++)
+        {
+            const float* tap_rows[max_filter_taps];
+
+            for (int k = 0; k < kernel.tap_count; k++)
+            {
+                const int source_y = std::clamp(2 * y + kernel.first_tap + k, 0, height - 1);
+                tap_rows[k] = source + static_cast<size_t>(source_y) * width;
+            }
+
+            int x = 0;
+
+            for (; x + V::lanes <= width; x += V::lanes)
+            {
+                V sum = V::broadcast(0.f);
+
+                for (int k = 0; k < kernel.tap_count; k++)
+                {
+                    sum = sum + V::broadcast(kernel.weights[k]) * V::load(tap_rows[k] + x);
+                }
+
+                sum.store(row_start + x);
+            }
+
+            for (; x < width; x++)
+            {
+                float sum = 0.f;
+
+                for (int k = 0; k < kernel.tap_count; k++)
+                {
+                    sum += kernel.weights[k] * tap_rows[k][x];
+                }
+
+                row_start[x] = sum;
+            }
+
+            // clamp-to-edge addressing, baked into the padding
+            std::fill(row, row_start, row_start[0]);
+            std::fill(row_start + width, row + padded_end, row_start[width - 1]);
+
+            float* const destination_row = destination + static_cast<size_t>(y) * next_width;
+
+            x = 0;
+
+            for (; x + V::lanes <= next_width; x += V::lanes)
+            {
+                V sum = V::broadcast(0.f);
+
+                for (int k = 0; k < kernel.tap_count; k += 2)
+                {
+                    const float* taps = row_start + 2 * x + kernel.first_tap + k;
+
+                    V even, odd;
+                    deinterleave(V::load(taps), V::load(taps + V::lanes), even, odd);
+
+                    sum = sum + V::broadcast(kernel.weights[k]) * even + V::broadcast(kernel.weights[k + 1]) * odd;
+                }
+
+                sum.store(destination_row + x);
+            }
+
+            for (; x < next_width; x++)
+            {
+                float sum = 0.f;
+
+                for (int k = 0; k < kernel.tap_count; k++)
+                {
+                    sum += kernel.weights[k] * row_start[2 * x + kernel.first_tap + k];
+                }
+
+                destination_row[x] = sum;
+            }
+        }
+    }
+
+    template <typename V>
+    std::vector<mip_level> build_levels(const unsigned char* pixels, int width, int height, const int channels, const mip_options& options)
+    {
+        std::vector<mip_level> levels;
+
+        if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) return levels;
+
+        const filter_kernel kernel = make_kernel(options.filter);
+
+        std::vector<float> current(static_cast<size_t>(width) * height * channels);
+        std::vector<float> next(static_cast<size_t>(std::max(width / 2, 1)) * std::max(height / 2, 1) * channels);
+        std::vector<float> row(static_cast<size_t>(width) + 2 * max_filter_taps + 2 * V::lanes + 2);
+
+        decode_to_planes(pixels, width, height, channels, options, current.data());
+
+        while (width > 1 || height > 1)
+        {
+            const int next_width = std::max(width / 2, 1);
+            const int next_height = std::max(height / 2, 1);
+            const size_t texel_count = static_cast<size_t>(width) * height;
+            const size_t next_texel_count = static_cast<size_t>(next_width) * next_height;
+
+            for (int c = 0; c < channels; c++)
+            {
+                downsample_plane<V>(current.data() + c * texel_count, width, height, next.data() + c * next_texel_count, next_width, next_height, kernel, row.data());
+            }
+
+            mip_level level{std::vector<unsigned char>(next_texel_count * channels), next_width, next_height};
+            encode_from_planes(next.data(), next_width, next_height, channels, options, level.pixels.data());
+            levels.push_back(std::move(level));
+
+            // the next level filters these floats rather than the requantized bytes, so rounding doesn't compound
+            std::swap(current, next);
+            width = next_width;
+            height = next_height;
+        }
+
+        return levels;
+    }
+}
+
+std::vector<mip_level> build_mip_levels(const unsigned char* pixels, const int width, const int height, const int channels, const mip_options& options)
+{
+    return build_levels<f32xn>(pixels, width, height, channels, options);
+}
+
+std::vector<mip_level> build_mip_levels_scalar(const unsigned char* pixels, const int width, const int height, const int channels, const mip_options& options)
+{
+    return build_levels<f32x1>(pixels, width, height, channels, options);
+}
@@ -0,0 +1,38 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <cstdint>
+#include <vector>
+
+enum class mip_filter : uint8_t
+{
+    box,    // 2x2 average: cheap, slightly soft and prone to aliasing on fine detail
+    kaiser  // 8-tap Kaiser-windowed sinc: sharper levels, meant for the offline cook step
+};
+
+struct mip_options
+{
+    mip_filter filter = mip_filter::box;
+
+    // colour channels hold sRGB-encoded values and are averaged in linear light; alpha is always linear
+    bool srgb = true;
+
+    // weight colour by alpha while filtering so the colour of fully transparent texels can't bleed into visible edges
+    bool premultiply_alpha = true;
+};
+
+struct mip_level
+{
+    std::vector<unsigned char> pixels;
+    int width;
+    int height;
+};
+
+// Levels 1..n (down to 1x1) of a tightly packed 8-bit image with 1-4 channels; alpha is the last channel of 2- and 4-channel
+// images. Filters in float, each level from the previous one, with SSE/AVX kernels. Safe to call from any thread.
+std::vector<mip_level> build_mip_levels(const unsigned char* pixels, int width, int height, int channels, const mip_options& options = {});
+
+// Same output from the one-lane instantiation of the kernels; reference and benchmark baseline
+std::vector<mip_level> build_mip_levels_scalar(const unsigned char* pixels, int width, int height, int channels, const mip_options& options = {});
+
+#endif // MIP_CHAIN_H
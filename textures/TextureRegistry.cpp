@@ -0,0 +1,353 @@
+#include "TextureRegistry.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <system_error>
+#include <utility>
+
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "../MappedFile.h"
+#include "../stb_image.h"
+
+namespace
+{
+    // A cooked sibling is used whenever it's at least as new as its source (or the source isn't shipped at all), so a
+    // stale .ctex never hides an edited image
+    std::string preferred_load_path(const std::string& source_path)
+    {
+        const std::string cooked_path = cooked_texture_path(source_path);
+
+        std::error_code error;
+        const auto cooked_time = std::filesystem::last_write_time(cooked_path, error);
+
+        if (error) return source_path;
+
+        const auto source_time = std::filesystem::last_write_time(source_path, error);
+
+        return error || cooked_time >= source_time ? cooked_path : source_path;
+    }
+
+    // "./assets/a.png" and "assets/../assets/a.png" are the same file
+    std::string canonical_texture_path(const std::string& path)
+    {
+        std::error_code error;
+        std::string canonical_path = std::filesystem::weakly_canonical(path, error).string();
+
+        return error ? path : canonical_path;
+    }
+
+    struct image_info
+    {
+        int width = 0;
+        int height = 0;
+        GLenum compressed_format = 0; // block format of a compressed cooked file, 0 otherwise
+    };
+
+    // Reads just enough of the file to size an array layer for it
+    bool read_image_info(const std::string& load_path, image_info& info)
+    {
+        if (load_path.size() > 5 && load_path.compare(load_path.size() - 5, 5, ".ctex") == 0)
+        {
+            const MappedFile file(load_path);
+            cooked_texture_view view;
+
+            if (!parse_cooked_texture(file.data(), file.size(), view)) return false;
+
+            info.width = static_cast<int>(view.header->width);
+            info.height = static_cast<int>(view.header->height);
+            info.compressed_format = view.header->flags & cooked_texture_compressed ? view.header->gl_internal_format : 0;
+
+            return true;
+        }
+
+        int channels;
+
+        return stbi_info(load_path.c_str(), &info.width, &info.height, &channels) != 0;
+    }
+
+    // a single block of the given format encoding a solid 4x4 of the placeholder colour
+    std::vector<unsigned char> placeholder_block(const block_format format)
+    {
+        unsigned char texels[4 * 4 * 4];
+
+        for (size_t i = 0; i < sizeof(texels); i += 4)
+        {
+            std::copy(std::begin(AsyncTextureLoader::placeholder_pixel), std::end(AsyncTextureLoader::placeholder_pixel), texels + i);
+        }
+
+        return compress_image(texels, 4, 4, 4, format, 1);
+    }
+
+    GLsizei full_mip_count(int width, int height)
+    {
+        GLsizei count = 1;
+
+        while (width > 1 || height > 1)
+        {
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+            count++;
+        }
+
+        return count;
+    }
+}
+
+texture_resource::~texture_resource()
+{
+    // borrowed textures belong to content_owner, which deletes them itself
+    if (!content_owner && id != 0)
+    {
+        glDeleteTextures(1, &id);
+    }
+}
+
+TextureRegistry::TextureRegistry()
+{
+    loader.before_upload = [this](const GLuint texture, const uint64_t content_hash)
+    {
+        return resolve_decoded(texture, content_hash);
+    };
+}
+
+TextureRegistry::~TextureRegistry()
+{
+    if (!layer_arrays.empty())
+    {
+        glDeleteTextures(static_cast<GLsizei>(layer_arrays.size()), layer_arrays.data());
+    }
+}
+
+TextureHandle TextureRegistry::acquire(const std::string& path)
+{
+    const std::string canonical_path = canonical_texture_path(path);
+
+    auto found = by_path.find(canonical_path);
+
+    if (found != by_path.end())
+    {
+        if (std::shared_ptr<texture_resource> existing = found->second.lock())
+        {
+            return TextureHandle(std::move(existing));
+        }
+
+        by_path.erase(found);
+    }
+
+    auto resource = std::make_shared<texture_resource>();
+    resource->canonical_path = canonical_path;
+    resource->id = loader.load(preferred_load_path(canonical_path));
+
+    by_path[canonical_path] = resource;
+    pending[resource->id] = resource;
+
+    drop_released_entries();
+
+    // room for every request that may still register its content in resolve_decoded()
+    if (by_content.capacity() < by_content.size() + pending.size())
+    {
+        by_content.reserve(std::max(by_content.size() + pending.size(), by_content.capacity() * 2));
+    }
+
+    return TextureHandle(std::move(resource));
+}
+
+std::vector<texture_layer> TextureRegistry::acquire_layers(const std::vector<std::string>& paths)
+{
+    struct packed_image
+    {
+        std::string canonical_path;
+        std::string load_path;
+        image_info info;
+    };
+
+    // images not packed yet, grouped by size; std::map keeps the array order (and so the output) deterministic
+    std::map<std::pair<int, int>, std::vector<packed_image>> groups;
+
+    for (const std::string& path : paths)
+    {
+        std::string canonical_path = canonical_texture_path(path);
+
+        if (layers_by_path.count(canonical_path)) continue;
+
+        // claimed right away so a path listed twice is only packed once; the real layer is filled in below
+        layers_by_path[canonical_path] = {};
+
+        packed_image image{canonical_path, preferred_load_path(canonical_path), {}};
+
+        if (!read_image_info(image.load_path, image.info))
+        {
+            std::cout << "ERROR::TEXTURE::LOAD_FAILED: " << image.load_path << '\n';
+            continue;
+        }
+
+        groups[{image.info.width, image.info.height}].push_back(std::move(image));
+    }
+
+    for (const auto& [size, members] : groups)
+    {
+        const auto [width, height] = size;
+
+        // cooked blocks can stay compressed only if every layer agrees on the format and the driver samples it
+        GLenum array_format = members.front().info.compressed_format;
+
+        for (const packed_image& member : members)
+        {
+            if (member.info.compressed_format != array_format) array_format = 0;
+        }
+
+        if (array_format == 0 || !loader.supports_compressed_format(array_format)) array_format = GL_RGBA8;
+
+        const auto layer_count = static_cast<GLsizei>(members.size());
+        const GLsizei level_count = full_mip_count(width, height);
+
+        GLuint array;
+        glGenTextures(1, &array);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+
+        // every level of every layer is allocated up front and filled with the placeholder colour, so the array can be
+        // sampled right away and each layer shows grey (like a texture from acquire()) until its upload lands
+        block_format blocks = block_format::bc1;
+        const bool compressed = block_format_from_gl(array_format, blocks);
+
+        // one placeholder block or texel, repeated over the whole of level 0; smaller levels use a prefix of it
+        const std::vector<unsigned char> placeholder = compressed
+            ? placeholder_block(blocks)
+            : std::vector<unsigned char>(std::begin(AsyncTextureLoader::placeholder_pixel), std::end(AsyncTextureLoader::placeholder_pixel));
+
+        const size_t level_0_size = compressed
+            ? compressed_image_size(blocks, width, height) * layer_count
+            : static_cast<size_t>(width) * height * layer_count * 4;
+
+        std::vector<unsigned char> fill(level_0_size);
+
+        for (size_t offset = 0; offset < fill.size(); offset += placeholder.size())
+        {
+            std::copy(placeholder.begin(), placeholder.end(), fill.begin() + static_cast<std::ptrdiff_t>(offset));
+        }
+
+        for (GLsizei level = 0; level < level_count; level++)
+        {
+            const int level_width = std::max(width >> level, 1);
+            const int level_height = std::max(height >> level, 1);
+
+            if (compressed)
+            {
+                const auto level_size = static_cast<GLsizei>(compressed_image_size(blocks, level_width, level_height) * layer_count);
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, array_format, level_width, level_height, layer_count, 0, level_size, fill.data());
+            }
+            else
+            {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, level_width, level_height, layer_count, 0, GL_RGBA, GL_UNSIGNED_BYTE, fill.data());
+            }
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        layer_arrays.push_back(array);
+
+        for (GLint layer = 0; layer < layer_count; layer++)
+        {
+            const packed_image& member = members[layer];
+
+            layers_by_path[member.canonical_path] = {array, layer};
+            loader.load_layer(member.load_path, array, layer, array_format);
+        }
+    }
+
+    std::vector<texture_layer> layers;
+    layers.reserve(paths.size());
+
+    for (const std::string& path : paths)
+    {
+        layers.push_back(layers_by_path[canonical_texture_path(path)]);
+    }
+
+    return layers;
+}
+
+void TextureRegistry::update()
+{
+    loader.upload_finished();
+}
+
+void TextureRegistry::finish_all()
+{
+    loader.finish_all();
+}
+
+size_t TextureRegistry::live_texture_count() const
+{
+    size_t count = 0;
+
+    for (const auto& [path, resource] : by_path)
+    {
+        if (!resource.expired()) count++;
+    }
+
+    return count;
+}
+
+// Forgets textures whose last handle is gone. Runs from acquire(), never inside the frame, so the maps stay as large as the
+// set of live textures and the by_content reservation doesn't grow with every texture ever loaded.
+void TextureRegistry::drop_released_entries()
+{
+    for (auto it = by_path.begin(); it != by_path.end();)
+    {
+        if (it->second.expired()) it = by_path.erase(it);
+        else ++it;
+    }
+
+    by_content.erase(std::remove_if(by_content.begin(), by_content.end(), [](const content_entry& entry) { return entry.resource.expired(); }), by_content.end());
+}
+
+bool TextureRegistry::resolve_decoded(const GLuint texture, const uint64_t content_hash)
+{
+    const auto found = pending.find(texture);
+
+    if (found == pending.end()) return false;
+
+    // dropping the pending reference here frees the resource if every handle to it was released while it was loading
+    const std::shared_ptr<texture_resource> resource = std::move(found->second);
+    pending.erase(found);
+
+    // nobody wants it anymore (or decoding failed), so don't spend an upload on it
+    if (resource.use_count() == 1 || content_hash == 0) return true;
+
+    const auto same_content = std::lower_bound(by_content.begin(), by_content.end(), content_hash,
+        [](const content_entry& entry, const uint64_t hash) { return entry.content_hash < hash; });
+
+    if (same_content == by_content.end() || same_content->content_hash != content_hash)
+    {
+        // fits in the capacity acquire() reserved, so this doesn't allocate
+        by_content.insert(same_content, {content_hash, resource});
+        return false;
+    }
+
+    std::shared_ptr<texture_resource> owner = same_content->resource.lock();
+
+    if (!owner)
+    {
+        // the previous owner was released; this texture takes its place
+        same_content->resource = resource;
+        return false;
+    }
+
+    // same bytes under another path: drop our placeholder and share the owner's texture instead
+    glDeleteTextures(1, &resource->id);
+    resource->id = owner->id;
+    resource->content_owner = std::move(owner);
+
+    return true;
+}
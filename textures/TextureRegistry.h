@@ -0,0 +1,114 @@
+#ifndef TEXTURE_REGISTRY_H
+#define TEXTURE_REGISTRY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "AsyncTextureLoader.h"
+
+// One GL texture shared by every handle that asked for the same image. Deletes the texture with the last reference,
+// which therefore has to be dropped on the GL thread while the context is still alive.
+struct texture_resource
+{
+    GLuint id = 0;
+    std::string canonical_path;
+    
+    // set when another path turned out to hold the same bytes: this resource then borrows that one's texture
+    std::shared_ptr<texture_resource> content_owner;
+
+    texture_resource() = default;
+    ~texture_resource();
+
+    texture_resource(const texture_resource&) = delete;
+    texture_resource& operator=(const texture_resource&) = delete;
+};
+
+// Refcounted reference to a registry texture; copy it freely, the texture lives as long as any copy does
+class TextureHandle
+{
+public:
+    TextureHandle() = default;
+
+    GLuint id() const { return resource ? resource->id : 0; }
+
+    explicit operator bool() const { return resource != nullptr; }
+
+    long use_count() const { return resource.use_count(); }
+
+private:
+    friend class TextureRegistry;
+
+    explicit TextureHandle(std::shared_ptr<texture_resource> resource) : resource(std::move(resource)) {}
+
+    std::shared_ptr<texture_resource> resource;
+};
+
+// Where a packed image lives: a layer of a GL_TEXTURE_2D_ARRAY shared with the other packed images of its size
+struct texture_layer
+{
+    GLuint array = 0;
+    GLint layer = -1;
+};
+
+// Loads each image once no matter how many materials ask for it. Requests are deduplicated by canonical path right away,
+// and by a hash of the file contents once decoded, so copies of one image under different names also share a texture.
+// Paths always name the source image; an up-to-date cooked .ctex next to it is loaded in its place.
+class TextureRegistry
+{
+public:
+    TextureRegistry();
+    ~TextureRegistry();
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    // GL thread only
+    TextureHandle acquire(const std::string& path);
+
+    // GL thread only. Packs the images into texture arrays, one per distinct size, so materials sharing an array need a single
+    // bind and pick their image by layer. Only image headers are read here; the layers fill in asynchronously like acquire().
+    // Returns each path's layer in order (array 0 if the image can't be read); paths packed by an earlier call keep their layer.
+    // The arrays live as long as the registry.
+    std::vector<texture_layer> acquire_layers(const std::vector<std::string>& paths);
+
+    // GL thread only, once per frame; forwards to AsyncTextureLoader::upload_finished
+    void update();
+
+    // GL thread only; blocks until every acquired texture is resident
+    void finish_all();
+
+    // distinct paths that still have at least one handle
+    size_t live_texture_count() const;
+
+private:
+    AsyncTextureLoader loader;
+
+    struct content_entry
+    {
+        uint64_t content_hash;
+        std::weak_ptr<texture_resource> resource;
+    };
+
+    std::unordered_map<std::string, std::weak_ptr<texture_resource>> by_path;
+
+    // sorted by hash. Entries are added from update(), inside the frame, so acquire() keeps enough capacity reserved for every
+    // pending request and a decoded texture never allocates when it's registered here.
+    std::vector<content_entry> by_content;
+
+    // requests still being decoded; the registry keeps them alive so a texture name can't be deleted (and reused by the
+    // driver) while a worker is about to upload into it
+    std::unordered_map<GLuint, std::shared_ptr<texture_resource>> pending;
+
+    std::unordered_map<std::string, texture_layer> layers_by_path;
+    std::vector<GLuint> layer_arrays;
+
+    bool resolve_decoded(GLuint texture, uint64_t content_hash);
+    void drop_released_entries();
+};
+
+#endif // TEXTURE_REGISTRY_H
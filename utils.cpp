@@ -1,79 +1,75 @@
 #include <fstream>
-#include <sstream>
 #include <glad/glad.h>
 
 #include "utils.h"
+#include "MappedFile.h"
 #include "stb_image.h"
 #include <glm/glm.hpp>
 
 #include "Camera.h"
+#include "InputState.h"
 
 extern glm::vec3 camera_position;
 extern glm::vec3 camera_front;
 extern glm::vec3 camera_up;
 
-extern float delta_time;
-extern float last_frame;
 
 extern Camera camera;
-
-float last_x = 400, last_y = 300;
-
-bool first_mouse = true;
+extern InputState input;
 
 unsigned char* load_image(const std::string& filepath, int& width, int& height, int& n_channels)
 {
-    return stbi_load(filepath.c_str(), &width, &height, &n_channels, 0);
+    const MappedFile file(filepath);
+
+    if (file.size() == 0) return nullptr;
+
+    return stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &n_channels, 0);
 }
 
-void process_input(GLFWwindow* window)
+void process_input(const input_snapshot& frame_input, const float delta_time)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (frame_input.is_key_down(GLFW_KEY_W))
         camera.process_keyboard(FORWARD, delta_time);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (frame_input.is_key_down(GLFW_KEY_S))
         camera.process_keyboard(BACKWARD, delta_time);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (frame_input.is_key_down(GLFW_KEY_A))
         camera.process_keyboard(LEFT, delta_time);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (frame_input.is_key_down(GLFW_KEY_D))
         camera.process_keyboard(RIGHT, delta_time);
 }
 
-void mouse_callback(GLFWwindow* window, double x_pos, double y_pos)
+void process_cursor_input(const input_snapshot& frame_input)
 {
-    if (first_mouse)
-    {
-        last_x = x_pos;
-        last_y = y_pos;
-        first_mouse = false;
-    }
-    
-    float x_offset = x_pos - last_x;
-    float y_offset = last_y - y_pos; // inverted: value increases from bottom to top; negative values rotate counter-clockwise.
-    last_x = x_pos;
-    last_y = y_pos;
+    if (frame_input.cursor_x_offset != 0.f || frame_input.cursor_y_offset != 0.f)
+        camera.process_mouse_movement(frame_input.cursor_x_offset, frame_input.cursor_y_offset);
 
-    camera.process_mouse_movement(x_offset, y_offset);
+    if (frame_input.scroll_y_offset != 0.f)
+        camera.process_mouse_scroll(frame_input.scroll_y_offset);
+}
+
+void mouse_callback(GLFWwindow* window, double x_pos, double y_pos)
+{
+    input.set_cursor_position(x_pos, y_pos);
 }
 
 void scroll_callback(GLFWwindow* window, double x_offset, double y_offset)
 {
-    camera.process_mouse_scroll(static_cast<float>(y_offset));
+    input.add_scroll(y_offset);
+}
+
+void key_callback(GLFWwindow* window, int key, int scan_code, int action, int mods)
+{
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    // repeats change nothing, the key is already down
+    if (action != GLFW_REPEAT)
+        input.set_key(key, action == GLFW_PRESS);
 }
 
 std::string read_file(const std::string& filename)
 {
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) return "";
-
-    std::stringstream stream;
-    stream << file.rdbuf();
-    file.close();
-    
-    return stream.str();
+    return std::string(MappedFile(filename).text());
 }
 
 float clamp(const float value, const float min, const float max)
@@ -113,4 +109,22 @@ glm::mat4 my_look_at(glm::vec3 position, glm::vec3 target, glm::vec3 worldUp)
 
     // Return lookAt matrix as combination of translation and rotation matrix
     return rotation * translation; // Remember to read from right to left (first translation then rotation)
-}   
\ No newline at end of file
+}
+
+bool write_ppm(const std::string& filename, const unsigned char* rgb_pixels, const int width, const int height)
+{
+    std::ofstream file(filename, std::ios::binary);
+
+    if (!file.is_open()) return false;
+
+    file << "P6\n" << width << ' ' << height << "\n255\n";
+
+    const size_t row_size = static_cast<size_t>(width) * 3;
+
+    for (int row = height - 1; row >= 0; row--)
+    {
+        file.write(reinterpret_cast<const char*>(rgb_pixels + row * row_size), static_cast<std::streamsize>(row_size));
+    }
+
+    return file.good();
+}
@@ -1,22 +1,51 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <GLFW/glfw3.h>
 #include <glm/fwd.hpp>
 
+// decodes straight from a mapping of the file; free the result with stbi_image_free
 unsigned char* load_image(const std::string& filepath, int& width, int& height, int& n_channels);
 
-void process_input(GLFWwindow* window);
+struct input_snapshot;
 
+// moves the camera by the keys held in this frame's input, once per fixed simulation step of delta_time seconds
+void process_input(const input_snapshot& frame_input, float delta_time);
+
+// turns and zooms the camera by this frame's accumulated cursor and scroll movement; once per frame
+void process_cursor_input(const input_snapshot& frame_input);
+
+// the callbacks only record events into the global InputState
 void mouse_callback(GLFWwindow* window, double x_pos, double y_pos);
 
 void scroll_callback(GLFWwindow* window, double x_offset, double y_offset);
 
+void key_callback(GLFWwindow* window, int key, int scan_code, int action, int mods);
+
+// owning copy of a whole file, empty if it can't be opened; map it with MappedFile instead when a view is enough
 std::string read_file(const std::string& filename);
 
+constexpr uint64_t fnv1a_64_offset_basis = 0xcbf29ce484222325ull;
+
+// 64-bit FNV-1a; pass a previous result as seed to hash several buffers as one
+constexpr uint64_t fnv1a_64(const unsigned char* data, const size_t size, uint64_t seed = fnv1a_64_offset_basis)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        seed = (seed ^ data[i]) * 0x100000001b3ull;
+    }
+
+    return seed;
+}
+
 float clamp(const float value, const float min, const float max);
 
 glm::mat4 my_look_at(glm::vec3 position, glm::vec3 target, glm::vec3 worldUp);
 
+// writes tightly packed RGB rows stored bottom row first (as glReadPixels returns them) to a binary PPM, top row first
+bool write_ppm(const std::string& filename, const unsigned char* rgb_pixels, int width, int height);
+
 #endif // UTILS_H